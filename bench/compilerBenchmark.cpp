@@ -0,0 +1,327 @@
+// File:  compilerBenchmark.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Reproducible timings for the compile pipeline on a corpus of saved checklist pages:
+//        parse throughput, taxonomy load time, and end-to-end Update() time for increasing
+//        numbers of checklists.  Pages are served by CorpusFetcher, so no network is needed.
+//        Usage:  compilerBenchmark <corpus directory> [--taxonomy <.csv>] [--iterations <n>] [--checklists <n>[,<n>...]]
+//        The corpus directory holds taxonomy.csv and a pages directory (see bench/corpus).
+
+// Local headers
+#include "corpusFetcher.h"
+#include "eBirdCompiler.h"
+#include "eBirdChecklistParser.h"
+#include "taxonomyOrder.h"
+#include "sharedTaxonomy.h"
+#include "httpCache.h"
+#include "checklistCache.h"
+#include "hostRateLimiter.h"
+#include "robotsCache.h"
+
+// Standard C++ headers
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <filesystem>
+#include <algorithm>
+
+#if defined(_MSC_VER) && _MSC_VER < 1914
+#define filesystem experimental::filesystem
+#endif
+
+typedef std::chrono::steady_clock Clock;
+
+static double SecondsSince(const Clock::time_point& start)
+{
+	return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+static bool ReadPages(const std::filesystem::path& directory, std::vector<std::shared_ptr<const std::string>>& pages)
+{
+	std::error_code ec;
+	std::vector<std::filesystem::path> files;
+	for (const auto& entry : std::filesystem::directory_iterator(directory, ec))
+	{
+		if (entry.is_regular_file(ec))
+			files.push_back(entry.path());
+	}
+
+	// Sorted so checklist S<n> gets the same page on every system
+	std::sort(files.begin(), files.end());
+	for (const auto& f : files)
+	{
+		std::ifstream file(f, std::ios::binary);
+		std::ostringstream ss;
+		if (!file.is_open() || !(ss << file.rdbuf()))
+		{
+			std::cerr << "Failed to read '" << f.string() << "'\n";
+			return false;
+		}
+
+		pages.push_back(std::make_shared<const std::string>(ss.str()));
+	}
+
+	return !ec;
+}
+
+static bool ParseCounts(const std::string& list, std::vector<unsigned int>& counts)
+{
+	counts.clear();
+	std::istringstream ss(list);
+	std::string token;
+	while (std::getline(ss, token, ','))
+	{
+		std::istringstream tokenStream(token);
+		unsigned int count;
+		if ((tokenStream >> count).fail() || count == 0)
+			return false;
+		counts.push_back(count);
+	}
+
+	return !counts.empty();
+}
+
+static void PrintParseResult(const std::string& name, const double& seconds, const std::size_t& bytes, const std::size_t& pageCount)
+{
+	std::cout << "  " << std::left << std::setw(12) << name << std::right << std::fixed
+		<< std::setw(10) << std::setprecision(0) << pageCount / seconds << " pages/s"
+		<< std::setw(10) << std::setprecision(1) << bytes / seconds / 1.0e6 << " MB/s\n";
+}
+
+template<typename ParseFunction>
+static double TimeParse(const std::vector<std::shared_ptr<const std::string>>& pages, const unsigned int& iterations, ParseFunction parse)
+{
+	const auto start(Clock::now());
+	for (unsigned int i = 0; i < iterations; ++i)
+	{
+		for (const auto& p : pages)
+		{
+			if (!parse(p))
+				return -1.0;
+		}
+	}
+
+	return SecondsSince(start);
+}
+
+static bool BenchmarkParser(const std::string& taxonomyFileName, const std::vector<std::shared_ptr<const std::string>>& pages, const unsigned int& iterations)
+{
+	TaxonomyOrder taxonomy("eBird Compiler Benchmark");
+	if (!taxonomy.Parse(taxonomyFileName))
+	{
+		std::cerr << "Failed to load taxonomy:  " << taxonomy.GetErrorString() << '\n';
+		return false;
+	}
+
+	std::size_t bytes(0);
+	for (const auto& p : pages)
+		bytes += p->length();
+
+	const double wholeTime(TimeParse(pages, iterations, [&taxonomy](const std::shared_ptr<const std::string>& html)
+	{
+		ChecklistInfo info;
+		return EBirdChecklistParser(taxonomy).Parse(*html, info) && !info.species.empty();
+	}));
+
+	const double viewTime(TimeParse(pages, iterations, [&taxonomy](const std::shared_ptr<const std::string>& html)
+	{
+		ChecklistView view;
+		return EBirdChecklistParser(taxonomy).Parse(html, view) && !view.species.empty();
+	}));
+
+	const double streamTime(TimeParse(pages, iterations, [&taxonomy](const std::shared_ptr<const std::string>& html)
+	{
+		const std::string::size_type pieceSize(16384);
+		EBirdChecklistParser parser(taxonomy);
+		parser.BeginStream();
+		for (std::string::size_type i = 0; i < html->length(); i += pieceSize)
+		{
+			if (!parser.Feed(std::string_view(*html).substr(i, pieceSize)))
+				return false;
+		}
+
+		ChecklistInfo info;
+		return parser.FinishStream(info) && !info.species.empty();
+	}));
+
+	if (wholeTime < 0.0 || viewTime < 0.0 || streamTime < 0.0)
+	{
+		std::cerr << "Failed to parse the corpus\n";
+		return false;
+	}
+
+	std::cout << "EBirdChecklistParser::Parse (" << iterations << " iterations)\n";
+	PrintParseResult("whole page", wholeTime, bytes * iterations, pages.size() * iterations);
+	PrintParseResult("views", viewTime, bytes * iterations, pages.size() * iterations);
+	PrintParseResult("streamed", streamTime, bytes * iterations, pages.size() * iterations);
+	return true;
+}
+
+// Taxonomy is copied into the working directory, so the binary cache is written there rather than next to the original
+static bool BenchmarkTaxonomy(const std::string& taxonomyFileName, const unsigned int& iterations)
+{
+	double csvTime(0.0), cacheTime(0.0);
+	unsigned int taxaCount(0);
+	for (unsigned int i = 0; i < iterations; ++i)
+	{
+		std::error_code ec;
+		std::filesystem::remove(TaxonomyOrder::GetCacheFileName(taxonomyFileName), ec);
+
+		TaxonomyOrder csvTaxonomy("eBird Compiler Benchmark");
+		auto start(Clock::now());
+		if (!csvTaxonomy.Parse(taxonomyFileName))
+		{
+			std::cerr << "Failed to load taxonomy:  " << csvTaxonomy.GetErrorString() << '\n';
+			return false;
+		}
+		const double csvSeconds(SecondsSince(start));
+
+		TaxonomyOrder cachedTaxonomy("eBird Compiler Benchmark");
+		start = Clock::now();
+		if (!cachedTaxonomy.Parse(taxonomyFileName))
+		{
+			std::cerr << "Failed to load cached taxonomy:  " << cachedTaxonomy.GetErrorString() << '\n';
+			return false;
+		}
+		const double cacheSeconds(SecondsSince(start));
+
+		csvTime = i == 0 ? csvSeconds : std::min(csvTime, csvSeconds);
+		cacheTime = i == 0 ? cacheSeconds : std::min(cacheTime, cacheSeconds);
+		taxaCount = cachedTaxonomy.GetTaxonCount();
+	}
+
+	std::cout << "Taxonomy load (" << taxaCount << " taxa, best of " << iterations << ")\n" << std::fixed << std::setprecision(2)
+		<< "  " << std::left << std::setw(12) << "csv" << std::right << std::setw(10) << csvTime * 1000.0 << " ms\n"
+		<< "  " << std::left << std::setw(12) << "cached" << std::right << std::setw(10) << cacheTime * 1000.0 << " ms\n";
+	return true;
+}
+
+// Pages are parsed as they are "downloaded", so this covers fetch, parse, aggregation and the summary
+static bool BenchmarkUpdate(const std::filesystem::path& workingDirectory, const std::string& taxonomyFileName,
+	const std::vector<std::shared_ptr<const std::string>>& pages, const std::vector<unsigned int>& checklistCounts, const unsigned int& iterations)
+{
+	EBirdCompiler::SharedResources resources;
+	resources.taxonomy = std::make_shared<SharedTaxonomy>("eBird Compiler Benchmark", taxonomyFileName);
+	resources.httpCache = std::make_shared<HTTPCache>((workingDirectory / "httpCache").string(), std::chrono::seconds(0), 0);
+	resources.rateLimiter = std::make_shared<HostRateLimiter>(HostRateLimiter::Clock::duration(0));
+	resources.robotsCache = std::make_shared<RobotsCache>((workingDirectory / "robotsCache").string(), std::chrono::seconds(0));
+	resources.fetcherFactory = [&pages]()
+	{
+		return std::make_unique<CorpusFetcher>(pages);
+	};
+
+	// Taxonomy load is timed separately
+	std::string errorString;
+	if (!resources.taxonomy->Get(errorString))
+	{
+		std::cerr << "Failed to load taxonomy:  " << errorString << '\n';
+		return false;
+	}
+
+	std::cout << "EBirdCompiler::Update (best of " << iterations << ")\n";
+	const std::string checklistCacheFileName((workingDirectory / "checklists.bin").string());
+	for (const auto& count : checklistCounts)
+	{
+		std::ostringstream checklists;
+		for (unsigned int i = 0; i < count; ++i)
+			checklists << 'S' << i + 1 << '\n';
+
+		double bestTime(0.0);
+		for (unsigned int i = 0; i < iterations; ++i)
+		{
+			std::error_code ec;
+			std::filesystem::remove(checklistCacheFileName, ec);
+			resources.checklistCache = std::make_shared<ChecklistCache>(checklistCacheFileName, std::max(count, 10000U));
+
+			EBirdCompiler compiler(resources);
+			const auto start(Clock::now());
+			if (!compiler.Update(checklists.str()) || compiler.GetSummaryString().empty())
+			{
+				std::cerr << "Update failed:  " << compiler.GetErrorString() << '\n';
+				return false;
+			}
+			const double seconds(SecondsSince(start));
+			bestTime = i == 0 ? seconds : std::min(bestTime, seconds);
+		}
+
+		std::cout << "  " << std::left << std::setw(12) << std::to_string(count) + " lists" << std::right << std::fixed
+			<< std::setw(10) << std::setprecision(2) << bestTime * 1000.0 << " ms"
+			<< std::setw(10) << std::setprecision(0) << count / bestTime << " checklists/s\n";
+	}
+
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		std::cerr << "Usage:  " << argv[0] << " <corpus directory> [--taxonomy <.csv>] [--iterations <n>] [--checklists <n>[,<n>...]]\n";
+		return 1;
+	}
+
+	const std::filesystem::path corpusDirectory(argv[1]);
+	std::filesystem::path taxonomySource(corpusDirectory / "taxonomy.csv");
+	unsigned int iterations(5);
+	std::vector<unsigned int> checklistCounts({ 10, 100, 1000 });
+	for (int i = 2; i < argc; ++i)
+	{
+		const std::string arg(argv[i]);
+		if (arg == "--taxonomy" && i + 1 < argc)
+			taxonomySource = argv[++i];
+		else if (arg == "--iterations" && i + 1 < argc)
+		{
+			std::istringstream ss(argv[++i]);
+			if ((ss >> iterations).fail() || iterations == 0)
+			{
+				std::cerr << "Invalid iteration count\n";
+				return 1;
+			}
+		}
+		else if (arg == "--checklists" && i + 1 < argc)
+		{
+			if (!ParseCounts(argv[++i], checklistCounts))
+			{
+				std::cerr << "Invalid checklist counts\n";
+				return 1;
+			}
+		}
+		else
+		{
+			std::cerr << "Unrecognized option '" << arg << "'\n";
+			return 1;
+		}
+	}
+
+	std::vector<std::shared_ptr<const std::string>> pages;
+	if (!ReadPages(corpusDirectory / "pages", pages) || pages.empty())
+	{
+		std::cerr << "No pages found in '" << (corpusDirectory / "pages").string() << "'\n";
+		return 1;
+	}
+
+	std::error_code ec;
+	const std::filesystem::path workingDirectory(std::filesystem::temp_directory_path(ec) / "eBirdCompilerBenchmark");
+	std::filesystem::remove_all(workingDirectory, ec);
+	std::filesystem::create_directories(workingDirectory, ec);
+	const std::string taxonomyFileName((workingDirectory / "taxonomy.csv").string());
+	if (ec || !std::filesystem::copy_file(taxonomySource, taxonomyFileName, ec))
+	{
+		std::cerr << "Failed to copy '" << taxonomySource.string() << "' to '" << workingDirectory.string() << "'\n";
+		return 1;
+	}
+
+	std::size_t bytes(0);
+	for (const auto& p : pages)
+		bytes += p->length();
+	std::cout << pages.size() << " pages (" << bytes / 1024 << " kB) from '" << corpusDirectory.string() << "'\n";
+
+	const bool succeeded(BenchmarkParser(taxonomyFileName, pages, iterations * 10) &&
+		BenchmarkTaxonomy(taxonomyFileName, iterations) &&
+		BenchmarkUpdate(workingDirectory, taxonomyFileName, pages, checklistCounts, iterations));
+
+	std::filesystem::remove_all(workingDirectory, ec);
+	return succeeded ? 0 : 1;
+}
@@ -0,0 +1,68 @@
+// File:  corpusFetcher.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Serves saved checklist pages in place of eBird, so a whole compile can be timed without
+//        a network.  Checklist S<n> is given page n modulo the corpus size, so any number of
+//        checklists can be requested from a handful of pages.
+
+// Local headers
+#include "corpusFetcher.h"
+
+// Standard C++ headers
+#include <cctype>
+
+const std::string::size_type CorpusFetcher::chunkSize(16384);// CURL_MAX_WRITE_SIZE
+
+CorpusFetcher::CorpusFetcher(const std::vector<std::shared_ptr<const std::string>>& pages) : pages(pages)
+{
+}
+
+bool CorpusFetcher::GetHTML(const std::string& url, std::string& html)
+{
+	const std::string* page(FindPage(url));
+	if (!page)
+		return false;
+
+	html = *page;
+	return true;
+}
+
+bool CorpusFetcher::GetHTML(const std::vector<std::string>& urls, const ResponseHandler& handler, const ChunkHandler& chunkHandler)
+{
+	for (std::vector<std::string>::size_type i = 0; i < urls.size(); ++i)
+	{
+		const std::string* page(FindPage(urls[i]));
+		bool success(page != nullptr);
+		std::string html;
+		if (success && chunkHandler)
+		{
+			const std::string_view data(*page);
+			for (std::string_view::size_type start = 0; success && start < data.length(); start += chunkSize)
+				success = chunkHandler(i, data.substr(start, chunkSize));
+		}
+		else if (success)
+			html = *page;
+
+		if (!handler(i, success, html))
+			return false;
+	}
+
+	return true;
+}
+
+const std::string* CorpusFetcher::FindPage(const std::string& url) const
+{
+	const auto idStart(url.find_last_of('S'));
+	if (pages.empty() || idStart == std::string::npos || idStart + 1 == url.length())
+		return nullptr;
+
+	std::size_t id(0);
+	for (std::string::size_type i = idStart + 1; i < url.length(); ++i)
+	{
+		if (!std::isdigit(static_cast<unsigned char>(url[i])))
+			return nullptr;
+		id = id * 10 + (url[i] - '0');
+	}
+
+	return pages[id % pages.size()].get();
+}
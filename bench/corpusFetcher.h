@@ -0,0 +1,39 @@
+// File:  corpusFetcher.h
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Serves saved checklist pages in place of eBird, so a whole compile can be timed without
+//        a network.  Checklist S<n> is given page n modulo the corpus size, so any number of
+//        checklists can be requested from a handful of pages.
+
+#ifndef CORPUS_FETCHER_H_
+#define CORPUS_FETCHER_H_
+
+// Local headers
+#include "pageFetcher.h"
+
+// Standard C++ headers
+#include <memory>
+
+class CorpusFetcher : public PageFetcher
+{
+public:
+	explicit CorpusFetcher(const std::vector<std::shared_ptr<const std::string>>& pages);
+
+	bool GetHTML(const std::string& url, std::string& html) override;
+
+	// With a chunk handler, pages are passed along in pieces the size of libcurl's receive buffer, as they would be
+	// when downloaded
+	bool GetHTML(const std::vector<std::string>& urls, const ResponseHandler& handler, const ChunkHandler& chunkHandler) override;
+
+	const std::vector<TransferStatistics>& GetStatistics() const override { return statistics; }
+
+private:
+	static const std::string::size_type chunkSize;
+
+	const std::vector<std::shared_ptr<const std::string>> pages;
+	const std::vector<TransferStatistics> statistics;// Always empty
+
+	const std::string* FindPage(const std::string& url) const;// nullptr if the URL doesn't name a checklist
+};
+
+#endif// CORPUS_FETCHER_H_
@@ -0,0 +1,55 @@
+// File:  legacyChecklistParser.h
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  The original std::string::find() based checklist parser, kept as a reference for
+//        checking and benchmarking EBirdChecklistParser.
+
+#ifndef LEGACY_CHECKLIST_PARSER_H_
+#define LEGACY_CHECKLIST_PARSER_H_
+
+// Local headers
+#include "eBirdChecklistParser.h"
+
+// Standard C++ headers
+#include <vector>
+#include <string>
+
+class LegacyChecklistParser
+{
+public:
+	LegacyChecklistParser(const TaxonomyOrder& taxonomy) : taxonomy(taxonomy) {}
+	
+	bool Parse(const std::string& html, ChecklistInfo& info);
+	std::string GetErrorString() const { return errorString; }
+	
+private:
+	std::string errorString;
+
+	const TaxonomyOrder& taxonomy;
+	
+	enum class Protocol
+	{
+		Traveling,
+		Stationary,
+		Incidential,
+		Other
+	};
+	
+	bool ExtractIdentifier(const std::string& html, std::string::size_type& position, std::string& identifier);
+	bool ExtractDate(const std::string& html, std::string::size_type& position, ChecklistInfo& info);
+	bool ExtractLocation(const std::string& html, std::string::size_type& position, std::string& location);
+	bool ExtractBirders(const std::string& html, std::string::size_type& position, std::vector<std::string>& birders);
+	bool ExtractProtocol(const std::string& html, std::string::size_type& position, Protocol& protocol);
+	bool ExtractDuration(const std::string& html, std::string::size_type& position, double& duration);
+	bool ExtractDistance(const std::string& html, std::string::size_type& position, double& distance);
+	bool ExtractSpeciesList(const std::string& html, std::string::size_type& position, std::vector<SpeciesInfo>& species);
+	bool ExtractSpeciesInfo(const std::string& html, std::string::size_type& position, SpeciesInfo& info, const std::string::size_type& maxPosition);
+	
+	static bool ExtractTextBetweenTags(const std::string& html, const std::string& startTag, const std::string& endTag, std::string& token, std::string::size_type& position, const std::string::size_type& maxPosition = std::string::npos);
+	static bool MoveToEndOfTag(const std::string& html, const std::string& tag, std::string::size_type& position, const std::string::size_type& maxPosition = std::string::npos);
+	static std::string::size_type FindEndTag(const std::string& html, std::string::size_type position, const std::string& tag);
+	
+	static std::vector<SpeciesInfo> MergeLists(const std::vector<std::vector<SpeciesInfo>>& lists);
+};
+
+#endif// LEGACY_CHECKLIST_PARSER_H_
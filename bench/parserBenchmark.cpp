@@ -0,0 +1,263 @@
+// File:  parserBenchmark.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Compares EBirdChecklistParser (whole page, views and incremental modes) against the original find()
+//        based parser on saved checklist pages.
+//        Usage:  parserBenchmark <taxonomy .csv> <page file or directory> [...] [--iterations <n>]
+
+// Local headers
+#include "eBirdChecklistParser.h"
+#include "legacyChecklistParser.h"
+#include "taxonomyOrder.h"
+#include "patternSearcher.h"
+
+// Standard C++ headers
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <filesystem>
+#include <algorithm>
+#include <memory>
+
+#if defined(_MSC_VER) && _MSC_VER < 1914
+#define filesystem experimental::filesystem
+#endif
+
+struct Page
+{
+	std::string fileName;
+	std::shared_ptr<const std::string> html;
+};
+
+static bool ReadPages(const std::filesystem::path& path, std::vector<Page>& pages)
+{
+	std::error_code ec;
+	if (std::filesystem::is_directory(path, ec))
+	{
+		std::vector<std::filesystem::path> files;
+		for (const auto& entry : std::filesystem::directory_iterator(path, ec))
+		{
+			if (entry.is_regular_file(ec))
+				files.push_back(entry.path());
+		}
+
+		std::sort(files.begin(), files.end());
+		for (const auto& f : files)
+		{
+			if (!ReadPages(f, pages))
+				return false;
+		}
+
+		return true;
+	}
+
+	std::ifstream file(path, std::ios::binary);
+	if (!file.is_open())
+	{
+		std::cerr << "Failed to open '" << path.string() << "'\n";
+		return false;
+	}
+
+	std::ostringstream ss;
+	ss << file.rdbuf();
+	pages.push_back(Page{ path.string(), std::make_shared<const std::string>(ss.str()) });
+	return true;
+}
+
+static bool SpeciesMatch(const std::vector<SpeciesInfo>& a, const std::vector<SpeciesInfo>& b)
+{
+	if (a.size() != b.size())
+		return false;
+
+	for (unsigned int i = 0; i < a.size(); ++i)
+	{
+		if (a[i].name != b[i].name || a[i].count != b[i].count || a[i].taxonomicOrder != b[i].taxonomicOrder)
+			return false;
+	}
+
+	return true;
+}
+
+static bool ChecklistsMatch(const ChecklistInfo& a, const ChecklistInfo& b)
+{
+	return a.identifier == b.identifier &&
+		a.birders == b.birders &&
+		a.location == b.location &&
+		a.distance == b.distance &&
+		a.duration == b.duration &&
+		a.year == b.year && a.month == b.month && a.day == b.day &&
+		SpeciesMatch(a.species, b.species);
+}
+
+template<typename Parser>
+static double TimeParser(const TaxonomyOrder& taxonomy, const std::vector<Page>& pages, const unsigned int& iterations, std::size_t& speciesCount)
+{
+	const auto start(std::chrono::steady_clock::now());
+	for (unsigned int i = 0; i < iterations; ++i)
+	{
+		for (const auto& p : pages)
+		{
+			ChecklistInfo info;
+			Parser parser(taxonomy);
+			if (parser.Parse(*p.html, info))
+				speciesCount += info.species.size();// Keeps the work from being optimized away
+		}
+	}
+
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static double TimeViewParser(const TaxonomyOrder& taxonomy, const std::vector<Page>& pages, const unsigned int& iterations, std::size_t& speciesCount)
+{
+	const auto start(std::chrono::steady_clock::now());
+	for (unsigned int i = 0; i < iterations; ++i)
+	{
+		for (const auto& p : pages)
+		{
+			ChecklistView view;
+			EBirdChecklistParser parser(taxonomy);
+			if (parser.Parse(p.html, view))
+				speciesCount += view.species.size();
+		}
+	}
+
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Feeds the page in pieces about the size of network reads
+static bool ParseInPieces(EBirdChecklistParser& parser, const std::string& html, ChecklistInfo& info)
+{
+	const std::string::size_type pieceSize(1460);
+	parser.BeginStream();
+	for (std::string::size_type i = 0; i < html.length() && !parser.IsStreamComplete(); i += pieceSize)
+	{
+		if (!parser.Feed(std::string_view(html).substr(i, pieceSize)))
+			break;
+	}
+	
+	return parser.FinishStream(info);
+}
+
+static double TimeStreamParser(const TaxonomyOrder& taxonomy, const std::vector<Page>& pages, const unsigned int& iterations, std::size_t& speciesCount)
+{
+	const auto start(std::chrono::steady_clock::now());
+	for (unsigned int i = 0; i < iterations; ++i)
+	{
+		for (const auto& p : pages)
+		{
+			ChecklistInfo info;
+			EBirdChecklistParser parser(taxonomy);
+			if (ParseInPieces(parser, *p.html, info))
+				speciesCount += info.species.size();
+		}
+	}
+
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void PrintResult(const std::string& name, const double& seconds, const std::size_t& bytes, const std::size_t& parseCount)
+{
+	std::cout << std::left << std::setw(10) << name << std::right << std::fixed
+		<< std::setw(10) << std::setprecision(3) << seconds << " s"
+		<< std::setw(10) << std::setprecision(1) << bytes / seconds / 1.0e6 << " MB/s"
+		<< std::setw(10) << std::setprecision(1) << seconds / parseCount * 1.0e6 << " us/page\n";
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 3)
+	{
+		std::cerr << "Usage:  " << argv[0] << " <taxonomy .csv> <page file or directory> [...] [--iterations <n>]\n";
+		return 1;
+	}
+
+	unsigned int iterations(20);
+	std::vector<Page> pages;
+	for (int i = 2; i < argc; ++i)
+	{
+		const std::string arg(argv[i]);
+		if (arg == "--iterations" && i + 1 < argc)
+		{
+			std::istringstream ss(argv[++i]);
+			if ((ss >> iterations).fail() || iterations == 0)
+			{
+				std::cerr << "Invalid iteration count\n";
+				return 1;
+			}
+		}
+		else if (!ReadPages(arg, pages))
+			return 1;
+	}
+
+	if (pages.empty())
+	{
+		std::cerr << "No pages found\n";
+		return 1;
+	}
+
+	TaxonomyOrder taxonomy("eBird Compiler Benchmark");
+	if (!taxonomy.Parse(argv[1]))
+	{
+		std::cerr << "Failed to load taxonomy:  " << taxonomy.GetErrorString() << '\n';
+		return 1;
+	}
+
+	// All parsers must agree before their speeds mean anything
+	std::size_t bytes(0);
+	unsigned int mismatchCount(0);
+	for (const auto& p : pages)
+	{
+		bytes += p.html->length();
+
+		ChecklistInfo legacyInfo, info, streamInfo;
+		ChecklistView view;
+		LegacyChecklistParser legacyParser(taxonomy);
+		EBirdChecklistParser parser(taxonomy), viewParser(taxonomy), streamParser(taxonomy);
+		const bool legacyOK(legacyParser.Parse(*p.html, legacyInfo));
+		const bool ok(parser.Parse(*p.html, info));
+		const bool viewOK(viewParser.Parse(p.html, view));
+		const bool streamOK(ParseInPieces(streamParser, *p.html, streamInfo));
+		if (legacyOK != ok || viewOK != ok || streamOK != ok ||
+			(ok && (!ChecklistsMatch(legacyInfo, info) || !ChecklistsMatch(info, view.ToChecklistInfo()) || !ChecklistsMatch(info, streamInfo))) ||
+			(!ok && (legacyParser.GetErrorString() != parser.GetErrorString() || streamParser.GetErrorString() != parser.GetErrorString())))
+		{
+			std::cerr << "Results differ for '" << p.fileName << "'\n";
+			++mismatchCount;
+		}
+	}
+
+	std::cout << pages.size() << " pages (" << bytes / 1024 << " kB), " << iterations << " iterations\n";
+	switch (PatternSearcher::GetInstructionSet())
+	{
+	case PatternSearcher::InstructionSet::AVX2:
+		std::cout << "Pattern search using AVX2\n";
+		break;
+	case PatternSearcher::InstructionSet::SSE2:
+		std::cout << "Pattern search using SSE2\n";
+		break;
+	default:
+		std::cout << "Pattern search using scalar fallback\n";
+	}
+
+	std::size_t legacySpeciesCount(0), speciesCount(0), viewSpeciesCount(0), streamSpeciesCount(0);
+	const double legacyTime(TimeParser<LegacyChecklistParser>(taxonomy, pages, iterations, legacySpeciesCount));
+	const double time(TimeParser<EBirdChecklistParser>(taxonomy, pages, iterations, speciesCount));
+	const double viewTime(TimeViewParser(taxonomy, pages, iterations, viewSpeciesCount));
+	const double streamTime(TimeStreamParser(taxonomy, pages, iterations, streamSpeciesCount));
+
+	PrintResult("find()", legacyTime, bytes * iterations, pages.size() * iterations);
+	PrintResult("scanner", time, bytes * iterations, pages.size() * iterations);
+	PrintResult("views", viewTime, bytes * iterations, pages.size() * iterations);
+	PrintResult("stream", streamTime, bytes * iterations, pages.size() * iterations);
+	std::cout << "Speedup:  " << std::setprecision(2) << legacyTime / time << "x (" << legacyTime / viewTime << "x with views)\n";
+
+	if (mismatchCount > 0)
+	{
+		std::cerr << mismatchCount << " page(s) parsed differently\n";
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,286 @@
+// File:  replayServer.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Loopback HTTP server which serves the pages in a PageArchive, with configurable latency,
+//        bandwidth and error rate, for load testing concurrency, throttling and retries without
+//        a network.  Point the compiler at it by listing checklists as http://127.0.0.1:<port>/checklist/S...
+//        (--list writes such a list for every page in the archive).  POSIX only.
+//        Usage:  replayServer <archive> [--port <n>] [--latency <ms>] [--bandwidth <kB/s>] [--error-rate <fraction>]
+//                [--error-status <code>] [--retry-after <s>] [--crawl-delay <s>] [--seed <n>] [--list <file>] [--verbose]
+
+// Local headers
+#include "pageArchive.h"
+
+// Standard C++ headers
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <random>
+#include <algorithm>
+
+// POSIX headers
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+struct Options
+{
+	unsigned short port = 8080;
+	std::chrono::milliseconds latency = std::chrono::milliseconds(0);// Before each response
+	double bandwidth = 0.0;// [bytes/sec] per connection, 0 for unlimited
+	double errorRate = 0.0;// Fraction of page requests which get errorStatus instead
+	unsigned int errorStatus = 503;
+	unsigned int retryAfter = 0;// [sec] sent with errors if non-zero
+	unsigned int crawlDelay = 0;// [sec] included in the generated robots.txt if non-zero
+	unsigned int seed = 0;
+	bool verbose = false;
+};
+
+static bool SendAll(const int& socket, const char* data, std::size_t length)
+{
+	while (length > 0)
+	{
+		const ssize_t sent(send(socket, data, length, MSG_NOSIGNAL));
+		if (sent <= 0)
+			return false;
+		data += sent;
+		length -= sent;
+	}
+
+	return true;
+}
+
+// Body is sent in pieces, each held back until the bandwidth allows it
+static bool SendBody(const int& socket, const std::string& body, const double& bandwidth)
+{
+	if (bandwidth <= 0.0)
+		return SendAll(socket, body.data(), body.length());
+
+	const std::string::size_type pieceSize(std::max(static_cast<std::string::size_type>(bandwidth / 20.0), std::string::size_type(1)));
+	const auto start(std::chrono::steady_clock::now());
+	for (std::string::size_type position = 0; position < body.length(); position += pieceSize)
+	{
+		std::this_thread::sleep_until(start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(position / bandwidth)));
+		if (!SendAll(socket, body.data() + position, std::min(pieceSize, body.length() - position)))
+			return false;
+	}
+
+	return true;
+}
+
+static std::string GetStatusText(const unsigned int& status)
+{
+	switch (status)
+	{
+	case 200: return "OK";
+	case 404: return "Not Found";
+	case 429: return "Too Many Requests";
+	case 500: return "Internal Server Error";
+	case 503: return "Service Unavailable";
+	default: return "Error";
+	}
+}
+
+static std::string GetRobotsTxt(const Options& options)
+{
+	std::ostringstream ss;
+	ss << "User-agent: *\nDisallow:\n";
+	if (options.crawlDelay > 0)
+		ss << "Crawl-delay: " << options.crawlDelay << '\n';
+	return ss.str();
+}
+
+static void ServeConnection(const int socket, const PageArchive& archive, const Options& options, const unsigned int connectionID)
+{
+	std::mt19937 generator(options.seed + connectionID);
+	std::uniform_real_distribution<double> distribution(0.0, 1.0);
+	std::string request;
+	char buffer[4096];
+	bool keepAlive(true);
+	while (keepAlive)
+	{
+		std::string::size_type headerEnd;
+		while ((headerEnd = request.find("\r\n\r\n")) == std::string::npos)
+		{
+			const ssize_t received(recv(socket, buffer, sizeof(buffer), 0));
+			if (received <= 0)
+			{
+				close(socket);
+				return;
+			}
+			request.append(buffer, received);
+		}
+
+		// Requests have no body, so anything past the headers belongs to the next (pipelined) request
+		const std::string headers(request.substr(0, headerEnd));
+		request.erase(0, headerEnd + 4);
+
+		std::istringstream requestLine(headers.substr(0, headers.find("\r\n")));
+		std::string method, path, version;
+		requestLine >> method >> path >> version;
+
+		std::string lowerHeaders(headers);
+		std::transform(lowerHeaders.begin(), lowerHeaders.end(), lowerHeaders.begin(), ::tolower);
+		keepAlive = version == "HTTP/1.1" && lowerHeaders.find("\r\nconnection: close") == std::string::npos;
+
+		unsigned int status(200);
+		std::string body;
+		const auto page(archive.Find(path));
+		if (method != "GET" && method != "HEAD")
+			status = 500;
+		else if (page)
+		{
+			if (options.errorRate > 0.0 && distribution(generator) < options.errorRate)
+				status = options.errorStatus;
+			else
+				body = *page;
+		}
+		else if (path == "/robots.txt")
+			body = GetRobotsTxt(options);
+		else
+			status = 404;
+
+		if (status != 200)
+			body = GetStatusText(status) + '\n';
+
+		if (options.verbose)
+			std::cerr << connectionID << ":  " << method << ' ' << path << " -> " << status << '\n';
+
+		std::ostringstream response;
+		response << "HTTP/1.1 " << status << ' ' << GetStatusText(status) << "\r\n"
+			<< "Content-Type: " << (path == "/robots.txt" ? "text/plain" : "text/html; charset=utf-8") << "\r\n"
+			<< "Content-Length: " << body.length() << "\r\n";
+		if (status != 200 && options.retryAfter > 0)
+			response << "Retry-After: " << options.retryAfter << "\r\n";
+		response << "Connection: " << (keepAlive ? "keep-alive" : "close") << "\r\n\r\n";
+
+		std::this_thread::sleep_for(options.latency);
+		const std::string responseHeaders(response.str());
+		if (!SendAll(socket, responseHeaders.data(), responseHeaders.length()) ||
+			(method != "HEAD" && !SendBody(socket, body, options.bandwidth)))
+			break;
+	}
+
+	close(socket);
+}
+
+static bool WriteList(const std::string& fileName, const PageArchive& archive, const unsigned short& port)
+{
+	std::ofstream file(fileName);
+	if (!file.is_open())
+		return false;
+
+	for (const auto& url : archive.GetURLs())
+		file << "http://127.0.0.1:" << port << PageArchive::GetPath(url) << '\n';
+	return file.good();
+}
+
+template<typename T>
+static bool ReadValue(const char* arg, T& value)
+{
+	std::istringstream ss(arg);
+	return !(ss >> value).fail();
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		std::cerr << "Usage:  " << argv[0] << " <archive> [--port <n>] [--latency <ms>] [--bandwidth <kB/s>] [--error-rate <fraction>]\n"
+			<< "        [--error-status <code>] [--retry-after <s>] [--crawl-delay <s>] [--seed <n>] [--list <file>] [--verbose]\n";
+		return 1;
+	}
+
+	Options options;
+	std::string listFile;
+	for (int i = 2; i < argc; ++i)
+	{
+		const std::string arg(argv[i]);
+		bool valid(true);
+		if (arg == "--port" && i + 1 < argc)
+			valid = ReadValue(argv[++i], options.port);
+		else if (arg == "--latency" && i + 1 < argc)
+		{
+			unsigned int latency;
+			valid = ReadValue(argv[++i], latency);
+			options.latency = std::chrono::milliseconds(latency);
+		}
+		else if (arg == "--bandwidth" && i + 1 < argc)
+		{
+			valid = ReadValue(argv[++i], options.bandwidth);
+			options.bandwidth *= 1024.0;
+		}
+		else if (arg == "--error-rate" && i + 1 < argc)
+			valid = ReadValue(argv[++i], options.errorRate) && options.errorRate >= 0.0 && options.errorRate <= 1.0;
+		else if (arg == "--error-status" && i + 1 < argc)
+			valid = ReadValue(argv[++i], options.errorStatus);
+		else if (arg == "--retry-after" && i + 1 < argc)
+			valid = ReadValue(argv[++i], options.retryAfter);
+		else if (arg == "--crawl-delay" && i + 1 < argc)
+			valid = ReadValue(argv[++i], options.crawlDelay);
+		else if (arg == "--seed" && i + 1 < argc)
+			valid = ReadValue(argv[++i], options.seed);
+		else if (arg == "--list" && i + 1 < argc)
+			listFile = argv[++i];
+		else if (arg == "--verbose")
+			options.verbose = true;
+		else
+		{
+			std::cerr << "Unrecognized option '" << arg << "'\n";
+			return 1;
+		}
+
+		if (!valid)
+		{
+			std::cerr << "Invalid value for " << arg << '\n';
+			return 1;
+		}
+	}
+
+	PageArchive archive;
+	if (!archive.Load(argv[1]))
+	{
+		std::cerr << archive.GetErrorString() << '\n';
+		return 1;
+	}
+
+	if (!listFile.empty() && !WriteList(listFile, archive, options.port))
+	{
+		std::cerr << "Failed to write '" << listFile << "'\n";
+		return 1;
+	}
+
+	const int listener(socket(AF_INET, SOCK_STREAM, 0));
+	const int reuse(1);
+	setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+	sockaddr_in address = {};
+	address.sin_family = AF_INET;
+	address.sin_port = htons(options.port);
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	if (listener < 0 || bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(listener, SOMAXCONN) != 0)
+	{
+		std::cerr << "Failed to listen on 127.0.0.1:" << options.port << '\n';
+		return 1;
+	}
+
+	std::cerr << "Serving " << archive.GetPageCount() << " pages on http://127.0.0.1:" << options.port << '\n';
+	unsigned int connectionCount(0);
+	while (true)
+	{
+		const int connection(accept(listener, nullptr, nullptr));
+		if (connection < 0)
+			continue;
+
+		const int noDelay(1);
+		setsockopt(connection, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+		std::thread(ServeConnection, connection, std::cref(archive), std::cref(options), ++connectionCount).detach();
+	}
+
+	return 0;
+}
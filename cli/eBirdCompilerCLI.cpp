@@ -0,0 +1,404 @@
+// File:  eBirdCompilerCLI.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Command line front end for compiling checklist summaries without the GUI.  Each list
+//        of checklist URLs or IDs is an independent job, and several jobs are compiled at once.
+//        Usage:  eBirdCompiler-cli [--jobs <n> | --combined] [--output-dir <dir>] [--transfer-stats]
+//                [--profile <file>] [--trace <file>] [--record <archive> | --replay <archive>]
+//                [--taxonomy <csv>] [--previous-taxonomy <csv> ...] [list file or - ...]
+
+// Local headers
+#include "eBirdCompiler.h"
+#include "instrumentation.h"
+#include "pageArchive.h"
+#include "archiveFetcher.h"
+#include "recordingFetcher.h"
+
+// Standard C++ headers
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <map>
+#include <set>
+#include <cctype>
+#include <iomanip>
+
+#if defined(_MSC_VER) && _MSC_VER < 1914
+#define filesystem experimental::filesystem
+#endif
+
+struct Job
+{
+	std::string name;
+	std::string checklists;// URLs or IDs, as they would be entered in the GUI
+
+	bool succeeded = false;
+	std::string output;// Summary or error message
+	std::string warning;// e.g. checklists from different dates
+	std::vector<TransferStatistics> transfers;
+};
+
+static const std::string grandTotalName("grandTotal");
+
+static void PrintUsage(const std::string& programName)
+{
+	std::cerr << "Usage:  " << programName << " [--jobs <n> | --combined] [--output-dir <dir>] [--transfer-stats]\n"
+		<< "        [--profile <file>] [--trace <file>] [--record <archive> | --replay <archive>]\n"
+		<< "        [--taxonomy <csv>] [--previous-taxonomy <csv> ...] [list file or - ...]\n"
+		<< "  Each list file contains checklist URLs or IDs separated by whitespace, and is compiled into its own summary.\n"
+		<< "  '-' (or no list files) reads a list from stdin.\n"
+		<< "  --jobs <n>          Number of lists to compile at once (default is the number of hardware threads)\n"
+		<< "  --combined          Compile the lists together, downloading checklists shared between lists only once,\n"
+		<< "                      and add a grand total summary over every unique checklist\n"
+		<< "  --output-dir <dir>  Write each summary to <dir>/<list name>.txt instead of stdout\n"
+		<< "  --transfer-stats    Write the protocol, size and timing of each request to stderr\n"
+		<< "  --profile <file>    Write time spent in each stage (with histograms) and counters to <file> as JSON\n"
+		<< "  --trace <file>      Write a Chrome trace (chrome://tracing or https://ui.perfetto.dev) of every stage to <file>\n"
+		<< "  --record <archive>  Save every downloaded checklist page to <archive>\n"
+		<< "  --replay <archive>  Take checklist pages from <archive> (written with --record) instead of downloading them\n"
+		<< "  --taxonomy <csv>    eBird taxonomy file to compile against (default is the 2019 taxonomy, which is downloaded if missing)\n"
+		<< "  --previous-taxonomy <csv>\n"
+		<< "                      Also recognize common names from an earlier taxonomy, counting them as the taxa which\n"
+		<< "                      replaced them.  May be repeated, most recent first.\n";
+}
+
+static bool ReadJob(const std::string& fileName, Job& job)
+{
+	std::ostringstream ss;
+	if (fileName == "-")
+	{
+		job.name = "stdin";
+		ss << std::cin.rdbuf();
+	}
+	else
+	{
+		std::ifstream file(fileName);
+		if (!file.is_open())
+		{
+			std::cerr << "Failed to open '" << fileName << "'\n";
+			return false;
+		}
+
+		job.name = std::filesystem::path(fileName).stem().string();
+		ss << file.rdbuf();
+	}
+
+	job.checklists = ss.str();
+	return true;
+}
+
+// Names identify the summaries (and their output files), so lists with the same name (i.e. a/list.txt and b/list.txt)
+// have a number appended.  Case is ignored, since output files would still collide on case-insensitive file systems.
+static void MakeNamesUnique(const std::vector<std::string>& listFiles, const bool& combined, std::vector<Job>& jobs)
+{
+	auto toLower([](std::string name)
+	{
+		std::transform(name.begin(), name.end(), name.begin(), [](const unsigned char& c)
+		{
+			return static_cast<char>(std::tolower(c));
+		});
+		return name;
+	});
+
+	std::set<std::string> usedNames;
+	if (combined)
+		usedNames.insert(toLower(grandTotalName));
+
+	for (unsigned int i = 0; i < jobs.size(); ++i)
+	{
+		const std::string baseName(jobs[i].name);
+		for (unsigned int suffix = 2; !usedNames.insert(toLower(jobs[i].name)).second; ++suffix)
+			jobs[i].name = baseName + "-" + std::to_string(suffix);
+
+		if (jobs[i].name != baseName)
+			std::cerr << "Summary of '" << listFiles[i] << "' is named '" << jobs[i].name << "', since '" << baseName << "' is already taken\n";
+	}
+}
+
+static void WriteOutput(const std::string& outputDirectory, Job& job)
+{
+	if (outputDirectory.empty())
+		return;
+
+	const std::filesystem::path outputPath(std::filesystem::path(outputDirectory) / (job.name + ".txt"));
+	std::ofstream file(outputPath);
+	if (!file.is_open() || !(file << job.output))
+	{
+		job.output = "Failed to write '" + outputPath.string() + "'";
+		job.succeeded = false;
+	}
+}
+
+static void RunJob(const EBirdCompiler::SharedResources& resources, const std::string& outputDirectory, Job& job)
+{
+	EBirdCompiler compiler(resources);
+	const bool succeeded(compiler.Update(job.checklists));
+	job.transfers = compiler.GetTransferStatistics();
+	if (!succeeded)
+	{
+		job.output = compiler.GetErrorString();
+		return;
+	}
+
+	job.output = compiler.GetSummaryString();
+	job.warning = compiler.GetErrorString();
+	job.succeeded = true;
+	WriteOutput(outputDirectory, job);
+}
+
+// Compiles every list in one batch and appends a job holding the grand total
+static bool RunCombined(const EBirdCompiler::SharedResources& resources, const std::string& outputDirectory, std::vector<Job>& jobs)
+{
+	std::vector<EBirdCompiler::NamedList> lists;
+	for (const auto& job : jobs)
+		lists.push_back(EBirdCompiler::NamedList{ job.name, job.checklists });
+
+	EBirdCompiler compiler(resources);
+	if (!compiler.Update(lists))
+	{
+		std::cerr << compiler.GetErrorString() << '\n';
+		return false;
+	}
+
+	if (!compiler.GetErrorString().empty())
+		std::cerr << compiler.GetErrorString() << '\n';
+
+	Job total;
+	total.name = grandTotalName;
+	total.transfers = compiler.GetTransferStatistics();// Can't be split among lists which share checklists
+	jobs.push_back(total);
+	for (auto& job : jobs)
+	{
+		job.output = job.name == total.name ? compiler.GetSummaryString() : compiler.GetSummaryString(job.name);
+		job.succeeded = true;
+		WriteOutput(outputDirectory, job);
+	}
+
+	return true;
+}
+
+static void PrintTransferStatistics(const Job& job)
+{
+	std::uint64_t receivedBytes(0), decodedBytes(0);
+	unsigned int newConnections(0);
+	double totalTime(0.0);
+	std::map<std::string, unsigned int> protocolCounts;
+	std::cerr << std::fixed << std::setprecision(3);
+	for (const auto& t : job.transfers)
+	{
+		std::cerr << job.name << ":  " << t.responseCode << ' ' << (t.protocol.empty() ? "-" : t.protocol) << ' '
+			<< (t.contentEncoding.empty() ? "identity" : t.contentEncoding) << ' ' << (t.newConnection ? "new" : "reused")
+			<< "  " << t.headerBytes << " + " << t.bodyBytes << " bytes -> " << t.decodedBytes
+			<< "  connect " << t.connectTime << " s, first byte " << t.timeToFirstByte << " s, total " << t.totalTime << " s  " << t.url << '\n';
+
+		receivedBytes += t.headerBytes + t.bodyBytes;
+		decodedBytes += t.decodedBytes;
+		if (t.newConnection)
+			++newConnections;
+		totalTime += t.totalTime;
+		++protocolCounts[t.protocol.empty() ? "-" : t.protocol];
+	}
+
+	std::cerr << job.name << ":  " << job.transfers.size() << " requests over " << newConnections << " new connections (";
+	for (auto it = protocolCounts.begin(); it != protocolCounts.end(); ++it)
+		std::cerr << (it == protocolCounts.begin() ? "" : ", ") << it->first << ' ' << it->second;
+	std::cerr << "), " << receivedBytes << " bytes received for " << decodedBytes << " bytes of content, "
+		<< totalTime << " s total transfer time\n";
+	std::cerr.unsetf(std::ios::floatfield);
+}
+
+int main(int argc, char* argv[])
+{
+	unsigned int workerCount(std::max(std::thread::hardware_concurrency(), 1U));
+	bool combined(false);
+	bool transferStats(false);
+	std::string outputDirectory;
+	std::string profileFile;
+	std::string traceFile;
+	std::string recordFile;
+	std::string replayFile;
+	std::string taxonomyFile;
+	std::vector<std::string> previousTaxonomyFiles;
+	std::vector<std::string> listFiles;
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string arg(argv[i]);
+		if (arg == "--jobs" && i + 1 < argc)
+		{
+			std::istringstream ss(argv[++i]);
+			if ((ss >> workerCount).fail() || workerCount == 0)
+			{
+				std::cerr << "Invalid job count\n";
+				return 1;
+			}
+		}
+		else if (arg == "--combined")
+			combined = true;
+		else if (arg == "--output-dir" && i + 1 < argc)
+			outputDirectory = argv[++i];
+		else if (arg == "--transfer-stats")
+			transferStats = true;
+		else if (arg == "--profile" && i + 1 < argc)
+			profileFile = argv[++i];
+		else if (arg == "--trace" && i + 1 < argc)
+			traceFile = argv[++i];
+		else if (arg == "--record" && i + 1 < argc)
+			recordFile = argv[++i];
+		else if (arg == "--replay" && i + 1 < argc)
+			replayFile = argv[++i];
+		else if (arg == "--taxonomy" && i + 1 < argc)
+			taxonomyFile = argv[++i];
+		else if (arg == "--previous-taxonomy" && i + 1 < argc)
+			previousTaxonomyFiles.push_back(argv[++i]);
+		else if (arg == "--help" || arg == "-h")
+		{
+			PrintUsage(argv[0]);
+			return 0;
+		}
+		else if (arg.length() > 1 && arg.front() == '-')
+		{
+			std::cerr << "Unrecognized option '" << arg << "'\n";
+			PrintUsage(argv[0]);
+			return 1;
+		}
+		else
+			listFiles.push_back(arg);
+	}
+
+	if (!recordFile.empty() && !replayFile.empty())
+	{
+		std::cerr << "--record and --replay can't be used together\n";
+		return 1;
+	}
+
+	if (listFiles.empty())
+		listFiles.push_back("-");
+	else if (std::count(listFiles.begin(), listFiles.end(), "-") > 1)
+	{
+		std::cerr << "stdin can only be read once\n";
+		return 1;
+	}
+
+	std::vector<Job> jobs(listFiles.size());
+	for (unsigned int i = 0; i < listFiles.size(); ++i)
+	{
+		if (!ReadJob(listFiles[i], jobs[i]))
+			return 1;
+	}
+
+	MakeNamesUnique(listFiles, combined, jobs);
+
+	if (!outputDirectory.empty())
+	{
+		std::error_code ec;
+		std::filesystem::create_directories(outputDirectory, ec);
+		if (ec)
+		{
+			std::cerr << "Failed to create output directory '" << outputDirectory << "'\n";
+			return 1;
+		}
+	}
+
+	// All jobs share one taxonomy, one set of caches and one rate limit
+	auto resources(EBirdCompiler::CreateSharedResources());
+	if (!taxonomyFile.empty() || !previousTaxonomyFiles.empty())
+		resources.taxonomy = EBirdCompiler::CreateSharedTaxonomy(taxonomyFile.empty() ? EBirdCompiler::GetDefaultTaxonomyFileName() : taxonomyFile, previousTaxonomyFiles);
+	const auto archive(std::make_shared<PageArchive>());
+	if (!replayFile.empty())
+	{
+		if (!archive->Load(replayFile))
+		{
+			std::cerr << archive->GetErrorString() << '\n';
+			return 1;
+		}
+
+		resources.fetcherFactory = [archive]()
+		{
+			return std::make_unique<ArchiveFetcher>(archive);
+		};
+	}
+	else if (!recordFile.empty())
+	{
+		const auto downloadResources(resources);
+		resources.fetcherFactory = [downloadResources, archive]()
+		{
+			return std::make_unique<RecordingFetcher>(EBirdCompiler::CreateRetriever(downloadResources), archive);
+		};
+	}
+
+	if (!profileFile.empty() || !traceFile.empty())
+		Instrumentation::Enable();
+
+	if (combined)
+	{
+		if (!RunCombined(resources, outputDirectory, jobs))
+			return 1;
+	}
+	else
+	{
+		std::atomic<std::vector<Job>::size_type> nextJob(0);
+		std::vector<std::thread> workers;
+		workerCount = std::min(workerCount, static_cast<unsigned int>(jobs.size()));
+		for (unsigned int i = 0; i < workerCount; ++i)
+		{
+			workers.emplace_back([&resources, &outputDirectory, &jobs, &nextJob]()
+			{
+				std::vector<Job>::size_type j;
+				while ((j = nextJob++) < jobs.size())
+					RunJob(resources, outputDirectory, jobs[j]);
+			});
+		}
+
+		for (auto& w : workers)
+			w.join();
+	}
+
+	int result(0);
+	if (!recordFile.empty() && !archive->Save(recordFile))
+	{
+		std::cerr << archive->GetErrorString() << '\n';
+		result = 1;
+	}
+
+	if (!profileFile.empty() && !Instrumentation::WriteJSON(profileFile))
+	{
+		std::cerr << "Failed to write '" << profileFile << "'\n";
+		result = 1;
+	}
+
+	if (!traceFile.empty() && !Instrumentation::WriteChromeTrace(traceFile))
+	{
+		std::cerr << "Failed to write '" << traceFile << "'\n";
+		result = 1;
+	}
+
+	for (const auto& job : jobs)
+	{
+		if (transferStats && !job.transfers.empty())
+			PrintTransferStatistics(job);
+
+		if (!job.succeeded)
+		{
+			std::cerr << job.name << ":  " << job.output << '\n';
+			result = 1;
+		}
+		else
+		{
+			if (!job.warning.empty())
+				std::cerr << job.name << ":  " << job.warning << '\n';
+			if (outputDirectory.empty())
+			{
+				if (jobs.size() > 1)
+					std::cout << "=== " << job.name << " ===\n";
+				std::cout << job.output;
+			}
+		}
+	}
+
+	return result;
+}
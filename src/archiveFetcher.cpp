@@ -0,0 +1,36 @@
+// File:  archiveFetcher.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Serves pages from a PageArchive in place of downloading them, so a recorded compile can
+//        be repeated without a network.
+
+// Local headers
+#include "archiveFetcher.h"
+#include "pageArchive.h"
+
+ArchiveFetcher::ArchiveFetcher(std::shared_ptr<const PageArchive> archive) : archive(archive)
+{
+}
+
+bool ArchiveFetcher::GetHTML(const std::string& url, std::string& html)
+{
+	const auto page(archive->Find(url));
+	if (!page)
+		return false;
+
+	html = *page;
+	return true;
+}
+
+bool ArchiveFetcher::GetHTML(const std::vector<std::string>& urls, const ResponseHandler& handler, const ChunkHandler& /*chunkHandler*/)
+{
+	for (std::vector<std::string>::size_type i = 0; i < urls.size(); ++i)
+	{
+		std::string html;
+		const bool success(GetHTML(urls[i], html));
+		if (!handler(i, success, html))
+			return false;
+	}
+
+	return true;
+}
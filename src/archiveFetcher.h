@@ -0,0 +1,36 @@
+// File:  archiveFetcher.h
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Serves pages from a PageArchive in place of downloading them, so a recorded compile can
+//        be repeated without a network.
+
+#ifndef ARCHIVE_FETCHER_H_
+#define ARCHIVE_FETCHER_H_
+
+// Local headers
+#include "pageFetcher.h"
+
+// Standard C++ headers
+#include <memory>
+
+// Local forward declarations
+class PageArchive;
+
+class ArchiveFetcher : public PageFetcher
+{
+public:
+	explicit ArchiveFetcher(std::shared_ptr<const PageArchive> archive);
+
+	bool GetHTML(const std::string& url, std::string& html) override;// Fails for URLs not in the archive
+
+	// Pages are always passed whole to the response handler
+	bool GetHTML(const std::vector<std::string>& urls, const ResponseHandler& handler, const ChunkHandler& chunkHandler) override;
+
+	const std::vector<TransferStatistics>& GetStatistics() const override { return statistics; }
+
+private:
+	const std::shared_ptr<const PageArchive> archive;
+	const std::vector<TransferStatistics> statistics;// Always empty
+};
+
+#endif// ARCHIVE_FETCHER_H_
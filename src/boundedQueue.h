@@ -0,0 +1,89 @@
+// File:  boundedQueue.h
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Fixed-capacity, thread-safe FIFO for passing work between pipeline stages.
+
+#ifndef BOUNDED_QUEUE_H_
+#define BOUNDED_QUEUE_H_
+
+// Standard C++ headers
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <cassert>
+
+template <typename T>
+class BoundedQueue
+{
+public:
+	explicit BoundedQueue(const std::size_t& capacity) : capacity(capacity) { assert(capacity > 0); }
+	
+	// Blocks while the queue is full.  Returns false (and discards item) if the queue has been closed.
+	bool Push(T&& item);
+	
+	// Blocks while the queue is empty.  Returns false once the queue is closed and drained.
+	bool Pop(T& item);
+	
+	// Wakes all waiting threads; subsequent pushes fail and pops drain what remains
+	void Close();
+
+private:
+	const std::size_t capacity;
+	std::deque<T> items;
+	bool closed = false;
+	
+	std::mutex mutex;
+	std::condition_variable notFull;
+	std::condition_variable notEmpty;
+};
+
+template <typename T>
+bool BoundedQueue<T>::Push(T&& item)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	notFull.wait(lock, [this]()
+	{
+		return closed || items.size() < capacity;
+	});
+	
+	if (closed)
+		return false;
+		
+	items.push_back(std::move(item));
+	lock.unlock();
+	notEmpty.notify_one();
+	return true;
+}
+
+template <typename T>
+bool BoundedQueue<T>::Pop(T& item)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	notEmpty.wait(lock, [this]()
+	{
+		return closed || !items.empty();
+	});
+	
+	if (items.empty())
+		return false;
+		
+	item = std::move(items.front());
+	items.pop_front();
+	lock.unlock();
+	notFull.notify_one();
+	return true;
+}
+
+template <typename T>
+void BoundedQueue<T>::Close()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		closed = true;
+	}
+	
+	notFull.notify_all();
+	notEmpty.notify_all();
+}
+
+#endif// BOUNDED_QUEUE_H_
@@ -0,0 +1,290 @@
+// File:  checklistCache.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Persistent store of parsed checklists, keyed by checklist ID and a hash of the
+//        page they were parsed from, so unchanged pages need not be parsed again.
+
+// Local headers
+#include "checklistCache.h"
+#include "taxonomyOrder.h"
+
+// Standard C++ headers
+#include <fstream>
+#include <algorithm>
+#include <vector>
+#include <cstring>
+#include <filesystem>
+
+#if defined(_MSC_VER) && _MSC_VER < 1914
+#define filesystem experimental::filesystem
+#endif
+
+const char ChecklistCache::fileMagic[8] = { 'E', 'B', 'C', 'L', 'I', 'S', 'T', 'S' };
+const std::uint32_t ChecklistCache::fileVersion(3);// Increment whenever the record format changes
+const std::uint32_t ChecklistCache::maxLength(1 << 24);
+const std::uint64_t ChecklistCache::initialHash(14695981039346656037ull);
+
+ChecklistCache::ChecklistCache(const std::string& fileName, const std::size_t& maxRecords) : fileName(fileName), maxRecords(maxRecords)
+{
+}
+
+bool ChecklistCache::Find(const std::string& checklistID, const std::uint64_t& htmlHash, const TaxonomyOrder& taxonomy, ChecklistInfo& info)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	Load();
+	
+	auto it(records.find(checklistID));
+	if (it == records.end() || it->second.htmlHash != htmlHash || it->second.taxonomyFingerprint != taxonomy.GetFingerprint())
+		return false;
+		
+	if (!Deserialize(it->second.data, info))
+	{
+		records.erase(it);// Corrupt
+		modified = true;
+		return false;
+	}
+	
+	for (auto& s : info.species)
+	{
+		if (!taxonomy.GetTaxonIndex(s.name, s.taxonIndex))
+			return false;
+		s.taxonomicOrder = taxonomy.GetTaxonomicSequence(s.taxonIndex);
+	}
+	
+	it->second.lastUse = ++useCounter;
+	return true;
+}
+
+void ChecklistCache::Store(const std::string& checklistID, const std::uint64_t& htmlHash, const TaxonomyOrder& taxonomy, const ChecklistInfo& info)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	Load();
+	
+	Record& record(records[checklistID]);
+	record.htmlHash = htmlHash;
+	record.taxonomyFingerprint = taxonomy.GetFingerprint();
+	record.lastUse = ++useCounter;
+	Serialize(info, record.data);
+	modified = true;
+}
+
+void ChecklistCache::Store(const std::string& checklistID, const std::uint64_t& htmlHash, const TaxonomyOrder& taxonomy, const ChecklistView& view)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	Load();
+	
+	Record& record(records[checklistID]);
+	record.htmlHash = htmlHash;
+	record.taxonomyFingerprint = taxonomy.GetFingerprint();
+	record.lastUse = ++useCounter;
+	Serialize(view, record.data);// Straight from the page, without an intermediate copy
+	modified = true;
+}
+
+bool ChecklistCache::Save()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (!modified)
+		return true;
+		
+	// Drop the least recently used records beyond our limit
+	if (records.size() > maxRecords)
+	{
+		std::vector<std::pair<std::uint64_t, std::string>> byLastUse;
+		for (const auto& r : records)
+			byLastUse.push_back(std::make_pair(r.second.lastUse, r.first));
+		std::sort(byLastUse.begin(), byLastUse.end());
+		for (std::size_t i = 0; i < byLastUse.size() - maxRecords; ++i)
+			records.erase(byLastUse[i].second);
+	}
+	
+	// Write to a temporary file first so a partially written store is never picked up
+	const std::string tempFileName(fileName + ".tmp");
+	{
+		std::ofstream file(tempFileName, std::ios::binary | std::ios::trunc);
+		if (!file.good())
+			return false;
+			
+		file.write(fileMagic, sizeof(fileMagic));
+		Write(file, fileVersion);
+		Write(file, static_cast<std::uint64_t>(records.size()));
+		for (const auto& r : records)
+		{
+			Write(file, r.first);
+			Write(file, r.second.htmlHash);
+			Write(file, r.second.taxonomyFingerprint);
+			Write(file, r.second.lastUse);
+			Write(file, r.second.data);
+		}
+		
+		if (!file.good())
+			return false;
+	}
+	
+	std::error_code ec;
+	std::filesystem::rename(tempFileName, fileName, ec);
+	if (ec)
+	{
+		std::filesystem::remove(tempFileName, ec);
+		return false;
+	}
+	
+	modified = false;
+	return true;
+}
+
+void ChecklistCache::Load()
+{
+	if (loaded)
+		return;
+	loaded = true;
+	
+	std::ifstream file(fileName, std::ios::binary);
+	if (!file.good())
+		return;
+		
+	char magic[sizeof(fileMagic)];
+	std::uint32_t version;
+	std::uint64_t count;
+	if (file.read(magic, sizeof(magic)).fail() || std::memcmp(magic, fileMagic, sizeof(magic)) != 0 ||
+		!Read(file, version) || version != fileVersion || !Read(file, count))
+		return;
+		
+	for (std::uint64_t i = 0; i < count; ++i)
+	{
+		std::string checklistID;
+		Record record;
+		if (!Read(file, checklistID) || !Read(file, record.htmlHash) || !Read(file, record.taxonomyFingerprint) || !Read(file, record.lastUse) || !Read(file, record.data))
+		{
+			records.clear();// Corrupt - start over
+			return;
+		}
+		
+		useCounter = std::max(useCounter, record.lastUse);
+		records[checklistID] = std::move(record);
+	}
+}
+
+std::uint64_t ChecklistCache::Hash(std::string_view html, const std::uint64_t& previousHash)
+{
+	// 64-bit FNV-1a
+	std::uint64_t hash(previousHash);
+	for (const auto& c : html)
+	{
+		hash ^= static_cast<unsigned char>(c);
+		hash *= 1099511628211ull;
+	}
+	
+	return hash;
+}
+
+std::string ChecklistCache::GetChecklistID(const std::string& url)
+{
+	// Checklist URLs end with the ID (i.e. https://ebird.org/checklist/S12345678)
+	std::string::size_type end(url.find_first_of("?#"));
+	if (end == std::string::npos)
+		end = url.length();
+	while (end > 0 && url[end - 1] == '/')
+		--end;
+		
+	const auto slash(url.find_last_of('/', end == 0 ? 0 : end - 1));
+	if (slash == std::string::npos)
+		return url.substr(0, end);
+	return url.substr(slash + 1, end - slash - 1);
+}
+
+bool ChecklistCache::Read(std::istream& in, std::string& s)
+{
+	std::uint32_t length;
+	if (!Read(in, length) || length > maxLength)
+		return false;
+		
+	s.resize(length);
+	return length == 0 || !in.read(&s[0], length).fail();
+}
+
+void ChecklistCache::Write(std::ostream& out, const std::string& s)
+{
+	Write(out, static_cast<std::uint32_t>(s.length()));
+	out.write(s.data(), s.length());
+}
+
+// ChecklistInfo and ChecklistView have the same fields, so either can be written
+template <typename Checklist>
+void ChecklistCache::Serialize(const Checklist& checklist, std::string& data)
+{
+	std::size_t size(checklist.identifier.length() + checklist.location.length() + 64);
+	for (const auto& b : checklist.birders)
+		size += b.length() + sizeof(std::uint32_t);
+	for (const auto& s : checklist.species)
+		size += s.name.length() + sizeof(std::uint32_t) + sizeof(s.count);
+		
+	data.clear();
+	data.reserve(size);
+	AppendString(data, checklist.identifier);
+	Append(data, static_cast<std::uint32_t>(checklist.birders.size()));
+	for (const auto& b : checklist.birders)
+		AppendString(data, b);
+		
+	AppendString(data, checklist.location);
+	Append(data, checklist.distance);
+	Append(data, checklist.duration);
+	Append(data, checklist.day);
+	Append(data, checklist.month);
+	Append(data, checklist.year);
+	
+	Append(data, static_cast<std::uint32_t>(checklist.species.size()));
+	for (const auto& s : checklist.species)
+	{
+		// Taxonomic order is not stored - it's looked up again when the record is used
+		AppendString(data, s.name);
+		Append(data, s.count);
+	}
+}
+
+// Lengths are checked against what's left of the record, so a corrupt record can't cause a huge allocation
+bool ChecklistCache::Deserialize(std::string_view data, ChecklistInfo& info)
+{
+	std::uint32_t birderCount;
+	if (!ExtractString(data, info.identifier) || !Extract(data, birderCount) || birderCount > data.length() / sizeof(std::uint32_t))
+		return false;
+		
+	info.birders.resize(birderCount);
+	for (auto& b : info.birders)
+	{
+		if (!ExtractString(data, b))
+			return false;
+	}
+	
+	std::uint32_t speciesCount;
+	if (!ExtractString(data, info.location) || !Extract(data, info.distance) || !Extract(data, info.duration) ||
+		!Extract(data, info.day) || !Extract(data, info.month) || !Extract(data, info.year) || !Extract(data, speciesCount) ||
+		speciesCount > data.length() / sizeof(std::uint32_t))
+		return false;
+		
+	info.species.resize(speciesCount);
+	for (auto& s : info.species)
+	{
+		if (!ExtractString(data, s.name) || !Extract(data, s.count))
+			return false;
+	}
+	
+	return data.empty();
+}
+
+void ChecklistCache::AppendString(std::string& data, const std::string_view& s)
+{
+	Append(data, static_cast<std::uint32_t>(s.length()));
+	data.append(s);
+}
+
+bool ChecklistCache::ExtractString(std::string_view& data, std::string& s)
+{
+	std::uint32_t length;
+	if (!Extract(data, length) || length > data.length())
+		return false;
+		
+	s.assign(data.substr(0, length));
+	data.remove_prefix(length);
+	return true;
+}
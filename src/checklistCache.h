@@ -0,0 +1,118 @@
+// File:  checklistCache.h
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Persistent store of parsed checklists, keyed by checklist ID and a hash of the
+//        page they were parsed from, so unchanged pages need not be parsed again.  Records
+//        are only used with the same taxonomy they were parsed with.
+
+#ifndef CHECKLIST_CACHE_H_
+#define CHECKLIST_CACHE_H_
+
+// Local headers
+#include "eBirdChecklistParser.h"
+
+// Standard C++ headers
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <mutex>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+
+// Local forward declarations
+class TaxonomyOrder;
+
+class ChecklistCache
+{
+public:
+	ChecklistCache(const std::string& fileName, const std::size_t& maxRecords);
+	
+	// Which species are read from a page depends on the taxonomy, so records stored with a different one are misses
+	bool Find(const std::string& checklistID, const std::uint64_t& htmlHash, const TaxonomyOrder& taxonomy, ChecklistInfo& info);
+	void Store(const std::string& checklistID, const std::uint64_t& htmlHash, const TaxonomyOrder& taxonomy, const ChecklistInfo& info);
+	void Store(const std::string& checklistID, const std::uint64_t& htmlHash, const TaxonomyOrder& taxonomy, const ChecklistView& view);
+	bool Save();// Only writes the file if something has changed
+	
+	// To hash a page that arrives in pieces, pass the result for the previous pieces along with the next one
+	static const std::uint64_t initialHash;
+	static std::uint64_t Hash(std::string_view html, const std::uint64_t& previousHash = initialHash);
+	static std::string GetChecklistID(const std::string& url);
+
+private:
+	static const char fileMagic[8];
+	static const std::uint32_t fileVersion;
+	static const std::uint32_t maxLength;// Of any string read from the file (including whole records); anything longer means it's corrupt
+
+	const std::string fileName;
+	const std::size_t maxRecords;
+	
+	struct Record
+	{
+		std::uint64_t htmlHash;
+		std::uint64_t taxonomyFingerprint;
+		std::uint64_t lastUse;// Sequence number, for discarding old records
+		std::string data;// Serialized checklist, as it's stored in the file
+	};
+	
+	std::mutex mutex;
+	bool loaded = false;
+	bool modified = false;
+	std::uint64_t useCounter = 0;
+	std::unordered_map<std::string, Record> records;
+	
+	void Load();// Caller must hold mutex
+	
+	// Records are kept serialized, so pages parsed into a ChecklistView can be stored without copying them into a
+	// ChecklistInfo first (and are written to and read from the file as they are)
+	template <typename Checklist>
+	static void Serialize(const Checklist& checklist, std::string& data);
+	static bool Deserialize(std::string_view data, ChecklistInfo& info);
+	
+	static void AppendString(std::string& data, const std::string_view& s);
+	static bool ExtractString(std::string_view& data, std::string& s);
+	template <typename T>
+	static void Append(std::string& data, const T& value);
+	template <typename T>
+	static bool Extract(std::string_view& data, T& value);
+	
+	static bool Read(std::istream& in, std::string& s);
+	template <typename T>
+	static bool Read(std::istream& in, T& value);
+	
+	static void Write(std::ostream& out, const std::string& s);
+	template <typename T>
+	static void Write(std::ostream& out, const T& value);
+};
+
+template <typename T>
+void ChecklistCache::Append(std::string& data, const T& value)
+{
+	data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+bool ChecklistCache::Extract(std::string_view& data, T& value)
+{
+	if (data.length() < sizeof(value))
+		return false;
+		
+	std::memcpy(&value, data.data(), sizeof(value));
+	data.remove_prefix(sizeof(value));
+	return true;
+}
+
+template <typename T>
+bool ChecklistCache::Read(std::istream& in, T& value)
+{
+	return !in.read(reinterpret_cast<char*>(&value), sizeof(value)).fail();
+}
+
+template <typename T>
+void ChecklistCache::Write(std::ostream& out, const T& value)
+{
+	out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+#endif// CHECKLIST_CACHE_H_
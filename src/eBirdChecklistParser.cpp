@@ -6,40 +6,88 @@
 // Local headers
 #include "eBirdChecklistParser.h"
 #include "taxonomyOrder.h"
+#include "htmlTagScanner.h"
+#include "patternSearcher.h"
 
 // Standard C++ headers
-#include <sstream>
 #include <algorithm>
+#include <charconv>
+#include <unordered_map>
+#include <unordered_set>
+#include <cctype>
+
+const PatternSearcher EBirdChecklistParser::identifierTagStart("<h1 id=\"content\" role=\"heading\" class=\"Heading Heading--h6 Heading--minor u-stack-sm\">Checklist ");
+const PatternSearcher EBirdChecklistParser::dateTagStart("<time datetime=\"");
+const PatternSearcher EBirdChecklistParser::locationTag("<span class=\"is-visuallyHidden\">Location</span>");
+const PatternSearcher EBirdChecklistParser::ownerTag("<span class=\"is-visuallyHidden\">Owner</span>");
+const PatternSearcher EBirdChecklistParser::additionalBirdersTag("<h4 class=\"is-visuallyHidden\">Other participating eBirders</h4>");
+const PatternSearcher EBirdChecklistParser::breadcrumbsTag("<div class=\"Breadcrumbs Breadcrumbs--small Breadcrumbs--comma\">");
+const PatternSearcher EBirdChecklistParser::smallSpanTag("<span class=\"u-inline-xs\">");
+const PatternSearcher EBirdChecklistParser::spanTag("<span>");
+// Also marks the end of the (optional) list of additional birders
+const PatternSearcher EBirdChecklistParser::protocolStartTag("<div class=\"Heading Heading--h5 u-margin-none u-inline-xs\" title=\"Protocol: ");
+const PatternSearcher EBirdChecklistParser::durationStartTag("<span class=\"Badge Badge--plain Badge--icon\" title=\"Duration: ");
+const PatternSearcher EBirdChecklistParser::distanceStartTag("<span class=\"Badge Badge--plain Badge--icon\" title=\"Distance: ");
+const PatternSearcher EBirdChecklistParser::listStartTag("<div id=\"list\">");
+const PatternSearcher EBirdChecklistParser::additionalSpeciesTag("<h2 id=\"observations-others\" class=\"Heading Heading--h5 Heading--minor\" data-observationheading>Additional species");
+const PatternSearcher EBirdChecklistParser::sectionStartTag("<section");
+const PatternSearcher EBirdChecklistParser::speciesNameStartTag("<span class=\"Heading-main\" ");
+const PatternSearcher EBirdChecklistParser::countStartTag("<span class=\"is-visuallyHidden\">Number observed:&nbsp;</span>");
+const std::string_view::size_type EBirdChecklistParser::lookahead(std::max({ identifierTagStart.GetPattern().length(),
+	dateTagStart.GetPattern().length(), locationTag.GetPattern().length(), ownerTag.GetPattern().length(),
+	additionalBirdersTag.GetPattern().length(), breadcrumbsTag.GetPattern().length(), smallSpanTag.GetPattern().length(),
+	spanTag.GetPattern().length(), protocolStartTag.GetPattern().length(), durationStartTag.GetPattern().length(),
+	distanceStartTag.GetPattern().length(), listStartTag.GetPattern().length(), additionalSpeciesTag.GetPattern().length(),
+	sectionStartTag.GetPattern().length(), speciesNameStartTag.GetPattern().length(), countStartTag.GetPattern().length() }));
 
 bool EBirdChecklistParser::Parse(const std::string& html, ChecklistInfo& info)
 {
-	std::string::size_type position(0);
-	if (!ExtractIdentifier(html, position, info.identifier))
+	ChecklistView view;
+	if (!ParseView(html, view))
+		return false;
+		
+	info = view.ToChecklistInfo();
+	return true;
+}
+
+bool EBirdChecklistParser::Parse(std::shared_ptr<const std::string> html, ChecklistView& view)
+{
+	view.storage = html;
+	return ParseView(*html, view);
+}
+
+bool EBirdChecklistParser::ParseView(std::string_view html, ChecklistView& view)
+{
+	errorString.clear();
+	
+	// Each step picks up where the previous one stopped, so the page is scanned once from front to back
+	HTMLTagScanner scanner(html);
+	if (!ExtractIdentifier(scanner, view.identifier))
 	{
 		errorString = "Failed to find identifier";
 		return false;
 	}
 	
-	if (!ExtractDate(html, position, info))
+	if (!ExtractDate(scanner, view))
 	{
 		errorString = "Failed to find date";
 		return false;
 	}
 	
-	if (!ExtractLocation(html, position, info.location))
+	if (!ExtractLocation(scanner, view.location))
 	{
 		errorString = "Failed to find location";
 		return false;
 	}
 	
-	if (!ExtractBirders(html, position, info.birders))
+	if (!ExtractBirders(scanner, view.birders))
 	{
 		errorString = "Failed to find birder names";
 		return false;
 	}
 	
 	Protocol protocol;
-	if (!ExtractProtocol(html, position, protocol))
+	if (!ExtractProtocol(scanner, protocol))
 	{
 		errorString = "Failed to find protocol";
 		return false;
@@ -49,7 +97,7 @@ bool EBirdChecklistParser::Parse(const std::string& html, ChecklistInfo& info)
 
 	if (protocol == Protocol::Traveling || protocol == Protocol::Stationary)
 	{
-		if (!ExtractDuration(html, position, info.duration))
+		if (!ExtractDuration(scanner, view.duration))
 		{
 			if (errorString.empty())
 				errorString = "Failed to find duration";
@@ -57,11 +105,11 @@ bool EBirdChecklistParser::Parse(const std::string& html, ChecklistInfo& info)
 		}
 	}
 	else
-		info.duration = 0.0;
+		view.duration = 0.0;
 	
 	if (protocol == Protocol::Traveling)
 	{
-		if (!ExtractDistance(html, position, info.distance))
+		if (!ExtractDistance(scanner, view.distance))
 		{
 			if (errorString.empty())
 				errorString = "Failed to find distance";
@@ -69,9 +117,9 @@ bool EBirdChecklistParser::Parse(const std::string& html, ChecklistInfo& info)
 		}
 	}
 	else
-		info.distance = 0.0;
+		view.distance = 0.0;
 	
-	if (!ExtractSpeciesList(html, position, info.species))
+	if (!ExtractSpeciesList(scanner, view.species))
 	{
 		errorString = "Failed to find species list";
 		return false;
@@ -80,123 +128,152 @@ bool EBirdChecklistParser::Parse(const std::string& html, ChecklistInfo& info)
 	return true;
 }
 
-bool EBirdChecklistParser::ExtractIdentifier(const std::string& html, std::string::size_type& position, std::string& identifier)
+bool EBirdChecklistParser::ExtractIdentifier(HTMLTagScanner& scanner, std::string_view& identifier)
 {
-	const std::string identifierTagStart("<h1 id=\"content\" role=\"heading\" class=\"Heading Heading--h6 Heading--minor u-stack-sm\">Checklist ");
-	const std::string tagEnd("</h1>");
-	return ExtractTextBetweenTags(html, identifierTagStart, tagEnd, identifier, position);
+	return scanner.SkipTo(identifierTagStart) && scanner.ExtractAfterPrefix(identifierTagStart, "</h1>", identifier);
 }
 
-bool EBirdChecklistParser::ExtractDate(const std::string& html, std::string::size_type& position, ChecklistInfo& info)
+bool EBirdChecklistParser::ExtractDate(HTMLTagScanner& scanner, ChecklistView& view)
 {
-	const std::string dateTagStart("<time datetime=\"");
-	const std::string tagEnd("\">");
-	std::string token;
-	if (!ExtractTextBetweenTags(html, dateTagStart, tagEnd, token, position))
+	std::string_view token;
+	if (!scanner.SkipTo(dateTagStart) || !scanner.ExtractAfterPrefix(dateTagStart, "\">", token))
 		return false;
 		
-	std::istringstream ss(token);
-	bool failed((ss >> info.year).fail());
-	ss.ignore();
-	failed = failed || (ss >> info.month).fail();
-	ss.ignore();
-	failed = failed || (ss >> info.day).fail();
-
-	return !failed;
+	return ParseDate(token, view.year, view.month, view.day);
 }
 
-bool EBirdChecklistParser::ExtractLocation(const std::string& html, std::string::size_type& position, std::string& location)
+bool EBirdChecklistParser::ExtractLocation(HTMLTagScanner& scanner, std::string_view& location)
 {
-	const std::string locationTag("<span class=\"is-visuallyHidden\">Location</span>");
-	if (!MoveToEndOfTag(html, locationTag, position))
+	if (!scanner.SkipTo(locationTag))
 		return false;
 
-	const std::string spanTag("<span>");
-	const std::string spanEndTag("</span>");
-	return ExtractTextBetweenTags(html, spanTag, spanEndTag, location, position);
+	return scanner.SkipTo(spanTag) && scanner.ExtractContent(location);
 }
 
-bool EBirdChecklistParser::ExtractBirders(const std::string& html, std::string::size_type& position, std::vector<std::string>& birders)
+bool EBirdChecklistParser::ExtractBirders(HTMLTagScanner& scanner, std::vector<std::string_view>& birders)
 {
-	const std::string ownerTag("<span class=\"is-visuallyHidden\">Owner</span>");
-	if (!MoveToEndOfTag(html, ownerTag, position))
+	if (!scanner.SkipTo(ownerTag))
 		return false;
 
-	const std::string spanTag("<span>");
-	const std::string spanEndTag("</span>");
-	std::string token;
-	if (!ExtractTextBetweenTags(html, spanTag, spanEndTag, token, position))
+	std::string_view token;
+	if (!scanner.SkipTo(spanTag) || !scanner.ExtractContent(token))
 		return false;
-	birders.push_back(token);
+	birders.emplace_back(token);
 	
-	// Check to see if we have additional birders
-	const std::string additionalBirdersTag("<h4 class=\"is-visuallyHidden\">Other participating eBirders</h4>");
-	if (!MoveToEndOfTag(html, additionalBirdersTag, position))
+	// Check to see if we have additional birders (they're listed before the protocol, so no need to look beyond it)
+	if (!scanner.SkipTo(additionalBirdersTag, protocolStartTag))
 		return true;// Not an error
 		
-	const std::string breadcrumbsTag("<div class=\"Breadcrumbs Breadcrumbs--small Breadcrumbs--comma\">");
-	if (!MoveToEndOfTag(html, breadcrumbsTag, position))
+	if (!scanner.SkipTo(breadcrumbsTag))
 		return false;
 		
-	const std::string divEndTag("</div>");
-	auto divEndPosition(html.find(divEndTag, position));
-	if (divEndPosition == std::string::npos)
-		return false;
-
-	const std::string smallSpanTag("<span class=\"u-inline-xs\">");
-	while (ExtractTextBetweenTags(html, smallSpanTag, spanEndTag, token, position, divEndPosition))
-		birders.push_back(token);
+	while (scanner.Next())
+	{
+		if (scanner.IsEndTag() && HTMLTagScanner::NamesMatch(scanner.GetName(), "div"))
+			return true;
+		else if (scanner.StartsWith(smallSpanTag.GetPattern()))
+		{
+			if (!scanner.ExtractContent(token))
+				return false;
+			birders.emplace_back(token);
+		}
+	}
 	
+	return false;
+}
+
+bool EBirdChecklistParser::ExtractProtocol(HTMLTagScanner& scanner, Protocol& protocol)
+{
+	std::string_view token;
+	if (!scanner.SkipTo(protocolStartTag) || !scanner.ExtractAfterPrefix(protocolStartTag, "\">", token))
+		return false;
+		
+	protocol = ParseProtocol(token);
 	return true;
 }
 
-bool EBirdChecklistParser::ExtractProtocol(const std::string& html, std::string::size_type& position, Protocol& protocol)
+bool EBirdChecklistParser::ExtractDuration(HTMLTagScanner& scanner, double& duration)
 {
-	const std::string protocolStartTag("<div class=\"Heading Heading--h5 u-margin-none u-inline-xs\" title=\"Protocol: ");
-	const std::string endTag("\">");
-	std::string token;
-	if (!ExtractTextBetweenTags(html, protocolStartTag, endTag, token, position))
+	std::string_view token;
+	if (!scanner.SkipTo(durationStartTag) || !scanner.ExtractAfterPrefix(durationStartTag, "\"", token))
 		return false;
 		
+	return ParseDuration(token, duration);
+}
+
+bool EBirdChecklistParser::ExtractDistance(HTMLTagScanner& scanner, double& distance)
+{
+	std::string_view token;
+	if (!scanner.SkipTo(distanceStartTag) || !scanner.ExtractAfterPrefix(distanceStartTag, "\"", token))
+		return false;
+
+	return ParseDistance(token, distance);
+}
+
+bool EBirdChecklistParser::ExtractSpeciesList(HTMLTagScanner& scanner, std::vector<SpeciesView>& species)
+{
+	if (!scanner.SkipTo(listStartTag))
+		return false;
+
+	// TODO:  Would be good to have a check for the same event being entered as multiple checklists (i.e. participant A + particpant B) or more than once
+
+	SpeciesListState state;
+	while (scanner.Next())
+	{
+		if (ReadSpeciesTag(scanner, state, false) == TagResult::Finished)
+		{
+			species = MergeLists(state.lists);
+			SetUnmatchedNamesWarning(state);
+			return true;
+		}
+	}
+	
+	return false;
+}
+
+bool EBirdChecklistParser::ParseDate(std::string_view token, unsigned int& year, unsigned int& month, unsigned int& day)
+{
+	if (!ParseNumber(token, year) || token.empty())
+		return false;
+	token.remove_prefix(1);
+	if (!ParseNumber(token, month) || token.empty())
+		return false;
+	token.remove_prefix(1);
+	return ParseNumber(token, day);
+}
+
+EBirdChecklistParser::Protocol EBirdChecklistParser::ParseProtocol(std::string_view token)
+{
 	if (token == "Traveling")
-		protocol = Protocol::Traveling;
+		return Protocol::Traveling;
 	else if (token == "Stationary")
-		protocol = Protocol::Stationary;
+		return Protocol::Stationary;
 	else if (token == "Incidential")
-		protocol = Protocol::Incidential;
-	else
-		protocol = Protocol::Other;
-		
-	return true;
+		return Protocol::Incidential;
+	return Protocol::Other;
 }
 
-bool EBirdChecklistParser::ExtractDuration(const std::string& html, std::string::size_type& position, double& duration)
+bool EBirdChecklistParser::ParseDuration(std::string_view token, double& duration)
 {
-	const std::string durationStartTag("<span class=\"Badge Badge--plain Badge--icon\" title=\"Duration: ");
-	const std::string durationEndTag("\"");
-	std::string token;
-	if (!ExtractTextBetweenTags(html, durationStartTag, durationEndTag, token, position))
-		return false;
-		
+	std::string_view text(token);
 	double value;
-	std::istringstream ss(token);
-	if ((ss >> value).fail())
+	if (!ParseNumber(text, value))
 		return false;
-	ss.ignore();
-
-	if (ss.peek() == 'h')
+		
+	const char units(text.length() > 1 ? text[1] : '\0');// Skip the space between value and units
+	if (units == 'h')
 	{
 		duration = value * 60;
-		std::string::size_type temp(0);
-		if (MoveToEndOfTag(token, ", ", temp))
+		const auto minutesStart(token.find(", "));
+		if (minutesStart != std::string_view::npos)
 		{
-			ss.str(token.substr(temp));
-			if ((ss >> value).fail())
+			text = token.substr(minutesStart + 2);
+			if (!ParseNumber(text, value))
 				return false;
 			duration += value;
 		}
 	}
-	else if (ss.peek() == 'm')
+	else if (units == 'm')
 		duration = value;
 	else
 	{
@@ -207,23 +284,16 @@ bool EBirdChecklistParser::ExtractDuration(const std::string& html, std::string:
 	return true;
 }
 
-bool EBirdChecklistParser::ExtractDistance(const std::string& html, std::string::size_type& position, double& distance)
+bool EBirdChecklistParser::ParseDistance(std::string_view token, double& distance)
 {
-	const std::string distanceStartTag("<span class=\"Badge Badge--plain Badge--icon\" title=\"Distance: ");
-	const std::string distanceEndTag("\"");
-	std::string token;
-	if (!ExtractTextBetweenTags(html, distanceStartTag, distanceEndTag, token, position))
-		return false;
-
 	double value;
-	std::istringstream ss(token);
-	if ((ss >> value).fail())
+	if (!ParseNumber(token, value))
 		return false;
-	ss.ignore();
 	
-	if (ss.peek() == 'm')
+	const char units(token.length() > 1 ? token[1] : '\0');// Skip the space between value and units
+	if (units == 'm')
 		distance = value * 1.609344;
-	else if (ss.peek() == 'k')
+	else if (units == 'k')
 		distance = value;
 	else
 	{
@@ -234,160 +304,477 @@ bool EBirdChecklistParser::ExtractDistance(const std::string& html, std::string:
 	return true;
 }
 
-bool EBirdChecklistParser::ExtractTextBetweenTags(const std::string& html, const std::string& startTag, const std::string& endTag, std::string& token, std::string::size_type& position, const std::string::size_type& maxPosition)
+// Each species is a <section> containing the name and count.  If any part of a section can't be read, the
+// remainder of that list is skipped, but a name which isn't in the taxonomy only skips its own section (and is
+// reported).  The list ends at the </div> that closes the list start tag.
+EBirdChecklistParser::TagResult EBirdChecklistParser::ReadSpeciesTag(HTMLTagScanner& scanner, SpeciesListState& state, const bool& moreToCome) const
 {
-	const auto startPosition(html.find(startTag, position));
-	if (startPosition == std::string::npos)
-		return false;
-
-	const auto endPosition(html.find(endTag, startPosition + startTag.length()));
-	if (endPosition == std::string::npos)
-		return false;
+	if (HTMLTagScanner::NamesMatch(scanner.GetName(), "div"))
+	{
+		if (!scanner.IsEndTag())
+			++state.depth;
+		else if (state.depth > 0)
+			--state.depth;
+		else
+			return TagResult::Finished;
+	}
+	else if (scanner.StartsWith(additionalSpeciesTag.GetPattern()))
+	{
+		state.lists.push_back(std::vector<SpeciesView>());
+		state.inSection = false;
+		state.skippingList = false;
+	}
+	else if (state.skippingList)
+		return TagResult::Continue;
+	else if (scanner.StartsWith(sectionStartTag.GetPattern()))
+	{
+		state.inSection = true;
+		state.foundName = false;
+		state.foundCount = false;
+		state.expectingCount = false;
+	}
+	else if (!state.inSection)
+		return TagResult::Continue;
+	else if (scanner.IsEndTag() && HTMLTagScanner::NamesMatch(scanner.GetName(), "section"))
+	{
+		if (state.foundName && state.foundCount)
+			state.lists.back().push_back(state.info);
+		else
+			state.skippingList = true;
+		state.inSection = false;
+	}
+	else if (!state.foundName && scanner.StartsWith(speciesNameStartTag.GetPattern()))
+	{
+		std::string_view name;
+		if (!scanner.ExtractContent(name))
+		{
+			if (moreToCome)
+				return TagResult::Incomplete;
+			state.skippingList = true;
+			return TagResult::Continue;
+		}
 		
-	if (endPosition > maxPosition)
-		return false;
+		const bool exactMatch(taxonomy.GetTaxonIndex(name, state.info.taxonIndex));
+		if (!exactMatch && !taxonomy.MatchTaxonIndex(name, state.info.taxonIndex))
+		{
+			state.unmatchedNames.emplace_back(name);
+			state.inSection = false;
+			return TagResult::Continue;
+		}
 		
-	token = html.substr(startPosition + startTag.length(), endPosition - startPosition - startTag.length());
-	position = endPosition + endTag.length();
-	return true;
-}
-
-std::string::size_type EBirdChecklistParser::FindEndTag(const std::string& html, std::string::size_type position, const std::string& tag)
-{
-	unsigned int depth(0);
-	std::string::size_type nextStart, nextEnd;
-	while (nextStart = html.find("<" + tag, position), nextEnd = html.find("</" + tag, position), nextEnd != std::string::npos)
+		// The page text is discarded as we go when parsing incrementally, so refer to the taxonomy's copy of the name instead
+		// (likewise for names which only approximately match, so they can be looked up again from the checklist cache)
+		state.info.name = streaming || !exactMatch ? taxonomy.GetCommonName(state.info.taxonIndex) : name;
+		state.info.taxonomicOrder = taxonomy.GetTaxonomicSequence(state.info.taxonIndex);
+		state.foundName = true;
+	}
+	else if (state.foundName && !state.foundCount && scanner.StartsWith(countStartTag.GetPattern()))
+		state.expectingCount = true;
+	else if (state.expectingCount && scanner.StartsWith(spanTag.GetPattern()))
 	{
-		if (nextStart < nextEnd)
+		std::string_view token;
+		if (!scanner.ExtractContent(token))
 		{
-			position = nextStart + 1;
-			++depth;
+			if (moreToCome)
+				return TagResult::Incomplete;
+			state.expectingCount = false;
+			state.skippingList = true;
 		}
-		else if (depth > 0)
+		else
 		{
-			position = nextEnd + 1;
-			--depth;
+			state.expectingCount = false;
+			if (token == "X")
+			{
+				state.info.count = 0;
+				state.foundCount = true;
+			}
+			else if (ParseNumber(token, state.info.count))
+				state.foundCount = true;
+			else
+				state.skippingList = true;
 		}
-		else
-			return nextEnd;
 	}
 	
-	return std::string::npos;
+	return TagResult::Continue;
 }
 
-bool EBirdChecklistParser::ExtractSpeciesList(const std::string& html, std::string::size_type& position, std::vector<SpeciesInfo>& species)
+void EBirdChecklistParser::BeginStream()
 {
-	const std::string listStartTag("<div id=\"list\">");
-	if (!MoveToEndOfTag(html, listStartTag, position))
-		return false;
-
-	// TODO:  Would be good to have a check for the same event being entered as multiple checklists (i.e. participant A + particpant B) or more than once
+	streaming = true;
+	stage = Stage::Identifier;
+	pending.clear();
+	streamInfo = ChecklistInfo();
+	streamSpecies = SpeciesListState();
+	errorString.clear();
+}
 
-	const auto listEndPosition(FindEndTag(html, position, "div"));
-	if (listEndPosition == std::string::npos)
+bool EBirdChecklistParser::Feed(std::string_view data)
+{
+	if (stage == Stage::Done)
+		return true;
+	else if (stage == Stage::Failed)
 		return false;
 		
-	std::vector<std::vector<SpeciesInfo>> lists;
-	const std::string additionalSpeciesTag("<h2 id=\"observations-others\" class=\"Heading Heading--h5 Heading--minor\" data-observationheading>Additional species");
-	std::string::size_type nextListStart;
+	pending.append(data);
+	return ReadPending(true);
+}
 
-	do
+bool EBirdChecklistParser::FinishStream(ChecklistInfo& info)
+{
+	if (stage != Stage::Done && stage != Stage::Failed)
+		ReadPending(false);
+		
+	if (stage != Stage::Done)
 	{
-		nextListStart = html.find(additionalSpeciesTag, position);
-		lists.push_back(std::vector<SpeciesInfo>());
-		SpeciesInfo info;
-		while (ExtractSpeciesInfo(html, position, info, std::min(nextListStart, listEndPosition)))
-			lists.back().push_back(info);
-			
-		if (nextListStart != std::string::npos)
-			position = nextListStart + additionalSpeciesTag.length();
-	} while (nextListStart < listEndPosition);
-	
-	species = MergeLists(lists);
+		Fail();
+		return false;
+	}
 	
+	info = std::move(streamInfo);
 	return true;
 }
 
-bool EBirdChecklistParser::ExtractSpeciesInfo(const std::string& html, std::string::size_type& position, SpeciesInfo& info, const std::string::size_type& maxPosition)
+// Reads every complete tag in the pending text, then drops everything before the first one that couldn't be read yet
+bool EBirdChecklistParser::ReadPending(const bool& moreToCome)
 {
-	const std::string sectionStartTag("<section");
-	if (!MoveToEndOfTag(html, sectionStartTag, position, maxPosition))
-		return false;
+	HTMLTagScanner scanner(pending);
+	HTMLTagScanner::size_type readPosition(0);
+	while (stage != Stage::Done && stage != Stage::Failed && scanner.Next())
+	{
+		// Patterns extend past the end of some tags, so wait until the longest one could be compared
+		if (moreToCome && pending.length() - scanner.GetTagStart() < lookahead)
+			break;
+			
+		// Raw text must be skipped as a unit, or we'd mistake its content for tags when we resume
+		std::string_view rawText;
+		if (!scanner.IsEndTag() && (HTMLTagScanner::NamesMatch(scanner.GetName(), "script") ||
+			HTMLTagScanner::NamesMatch(scanner.GetName(), "style")))
+		{
+			if (!scanner.ExtractContent(rawText))
+				break;
+		}
+		else if (ReadStreamTag(scanner, moreToCome) == TagResult::Incomplete)
+			break;
+			
+		readPosition = scanner.GetTagEnd();
+	}
+	
+	if (stage == Stage::Done || stage == Stage::Failed)
+		pending.clear();
+	else
+		pending.erase(0, readPosition);
+		
+	return stage != Stage::Failed;
+}
 
-	const std::string speciesNameStartTag("<span class=\"Heading-main\" ");
-	if (!MoveToEndOfTag(html, speciesNameStartTag, position, maxPosition))
-		return false;
+EBirdChecklistParser::TagResult EBirdChecklistParser::ReadStreamTag(HTMLTagScanner& scanner, const bool& moreToCome)
+{
+	std::string_view token;
+	switch (stage)
+	{
+	case Stage::Identifier:
+		if (scanner.StartsWith(identifierTagStart.GetPattern()))
+		{
+			if (!scanner.ExtractAfterPrefix(identifierTagStart, "</h1>", token))
+				return TagResult::Incomplete;
+			streamInfo.identifier.assign(token);
+			stage = Stage::Date;
+		}
+		break;
 		
-	const std::string nameStartTag(">");
-	const std::string spanEndTag("</span>");
-	if (!ExtractTextBetweenTags(html, nameStartTag, spanEndTag, info.name, position, maxPosition))
-		return false;
+	case Stage::Date:
+		if (scanner.StartsWith(dateTagStart.GetPattern()))
+		{
+			if (!scanner.ExtractAfterPrefix(dateTagStart, "\">", token))
+				return TagResult::Incomplete;
+			else if (!ParseDate(token, streamInfo.year, streamInfo.month, streamInfo.day))
+				Fail();
+			else
+				stage = Stage::Location;
+		}
+		break;
 		
-	if (!taxonomy.GetTaxonomicSequence(info.name, info.taxonomicOrder))
-		return false;
+	case Stage::Location:
+		if (scanner.StartsWith(locationTag.GetPattern()))
+			stage = Stage::LocationName;
+		break;
 		
-	const std::string countStartTag("<span class=\"is-visuallyHidden\">Number observed:&nbsp;</span>");
-	if (!MoveToEndOfTag(html, countStartTag, position, maxPosition))
-		return false;
+	case Stage::LocationName:
+		if (scanner.StartsWith(spanTag.GetPattern()))
+		{
+			if (!scanner.ExtractContent(token))
+				return TagResult::Incomplete;
+			streamInfo.location.assign(token);
+			stage = Stage::Owner;
+		}
+		break;
+		
+	case Stage::Owner:
+		if (scanner.StartsWith(ownerTag.GetPattern()))
+			stage = Stage::OwnerName;
+		break;
+		
+	case Stage::OwnerName:
+		if (scanner.StartsWith(spanTag.GetPattern()))
+		{
+			if (!scanner.ExtractContent(token))
+				return TagResult::Incomplete;
+			streamInfo.birders.emplace_back(token);
+			stage = Stage::AdditionalBirders;
+		}
+		break;
+		
+	case Stage::AdditionalBirders:
+		if (scanner.StartsWith(additionalBirdersTag.GetPattern()))
+			stage = Stage::Breadcrumbs;
+		else if (scanner.StartsWith(protocolStartTag.GetPattern()))
+		{
+			stage = Stage::Protocol;
+			return ReadStreamTag(scanner, moreToCome);
+		}
+		break;
+		
+	case Stage::Breadcrumbs:
+		if (scanner.StartsWith(breadcrumbsTag.GetPattern()))
+			stage = Stage::AdditionalBirderNames;
+		break;
+		
+	case Stage::AdditionalBirderNames:
+		if (scanner.IsEndTag() && HTMLTagScanner::NamesMatch(scanner.GetName(), "div"))
+			stage = Stage::Protocol;
+		else if (scanner.StartsWith(smallSpanTag.GetPattern()))
+		{
+			if (!scanner.ExtractContent(token))
+				return TagResult::Incomplete;
+			streamInfo.birders.emplace_back(token);
+		}
+		break;
+		
+	case Stage::Protocol:
+		if (scanner.StartsWith(protocolStartTag.GetPattern()))
+		{
+			if (!scanner.ExtractAfterPrefix(protocolStartTag, "\">", token))
+				return TagResult::Incomplete;
+				
+			streamProtocol = ParseProtocol(token);
+			streamInfo.duration = 0.0;
+			streamInfo.distance = 0.0;
+			if (streamProtocol == Protocol::Traveling || streamProtocol == Protocol::Stationary)
+				stage = Stage::Duration;
+			else
+				stage = Stage::ListStart;
+		}
+		break;
+		
+	case Stage::Duration:
+		if (scanner.StartsWith(durationStartTag.GetPattern()))
+		{
+			if (!scanner.ExtractAfterPrefix(durationStartTag, "\"", token))
+				return TagResult::Incomplete;
+			else if (!ParseDuration(token, streamInfo.duration))
+				Fail();
+			else
+				stage = streamProtocol == Protocol::Traveling ? Stage::Distance : Stage::ListStart;
+		}
+		break;
+		
+	case Stage::Distance:
+		if (scanner.StartsWith(distanceStartTag.GetPattern()))
+		{
+			if (!scanner.ExtractAfterPrefix(distanceStartTag, "\"", token))
+				return TagResult::Incomplete;
+			else if (!ParseDistance(token, streamInfo.distance))
+				Fail();
+			else
+				stage = Stage::ListStart;
+		}
+		break;
+		
+	case Stage::ListStart:
+		if (scanner.StartsWith(listStartTag.GetPattern()))
+			stage = Stage::SpeciesList;
+		break;
+		
+	case Stage::SpeciesList:
+	{
+		const TagResult result(ReadSpeciesTag(scanner, streamSpecies, moreToCome));
+		if (result == TagResult::Finished)
+		{
+			const auto species(MergeLists(streamSpecies.lists));
+			streamInfo.species.resize(species.size());
+			for (unsigned int i = 0; i < species.size(); ++i)
+			{
+				streamInfo.species[i].name.assign(species[i].name);
+				streamInfo.species[i].count = species[i].count;
+				streamInfo.species[i].taxonomicOrder = species[i].taxonomicOrder;
+				streamInfo.species[i].taxonIndex = species[i].taxonIndex;
+			}
+			
+			SetUnmatchedNamesWarning(streamSpecies);
+			stage = Stage::Done;
+		}
+		return result;
+	}
+		
+	default:
+		break;
+	}
+	
+	return TagResult::Continue;
+}
 
-	const std::string spanStartTag("<span>");
-	std::string countToken;
-	if (!ExtractTextBetweenTags(html, spanStartTag, spanEndTag, countToken, position, maxPosition))
-		return false;
-	if (countToken == "X")
-		info.count = 0;
-	else
+void EBirdChecklistParser::Fail()
+{
+	if (errorString.empty())// Otherwise we already have a more specific message
+		errorString = GetStageErrorString();
+	stage = Stage::Failed;
+}
+
+std::string EBirdChecklistParser::GetStageErrorString() const
+{
+	switch (stage)
 	{
-		std::istringstream ss(countToken);
-		if ((ss >> info.count).fail())
-			return false;
+	case Stage::Identifier:
+		return "Failed to find identifier";
+	case Stage::Date:
+		return "Failed to find date";
+	case Stage::Location:
+	case Stage::LocationName:
+		return "Failed to find location";
+	case Stage::Owner:
+	case Stage::OwnerName:
+	case Stage::AdditionalBirders:
+	case Stage::Breadcrumbs:
+	case Stage::AdditionalBirderNames:
+		return "Failed to find birder names";
+	case Stage::Protocol:
+		return "Failed to find protocol";
+	case Stage::Duration:
+		return "Failed to find duration";
+	case Stage::Distance:
+		return "Failed to find distance";
+	default:
+		return "Failed to find species list";
 	}
+}
+
+bool EBirdChecklistParser::ParseNumber(std::string_view& text, double& value)
+{
+	while (!text.empty() && std::isspace(static_cast<unsigned char>(text.front())))
+		text.remove_prefix(1);
 	
-	const std::string sectionEndTag("</section>");
-	if (!MoveToEndOfTag(html, sectionEndTag, position, maxPosition))
+	const auto result(std::from_chars(text.data(), text.data() + text.length(), value));
+	if (result.ec != std::errc())
 		return false;
-	
+		
+	text.remove_prefix(result.ptr - text.data());
 	return true;
 }
 
-bool EBirdChecklistParser::MoveToEndOfTag(const std::string& html, const std::string& tag, std::string::size_type& position, const std::string::size_type& maxPosition)
+bool EBirdChecklistParser::ParseNumber(std::string_view& text, unsigned int& value)
 {
-	const auto tagPosition(html.find(tag, position));
-	if (tagPosition == std::string::npos)
-		return false;
-
-	if (tagPosition + tag.length() > maxPosition)
+	while (!text.empty() && std::isspace(static_cast<unsigned char>(text.front())))
+		text.remove_prefix(1);
+	
+	const auto result(std::from_chars(text.data(), text.data() + text.length(), value));
+	if (result.ec != std::errc())
 		return false;
 		
-	position = tagPosition + tag.length();
+	text.remove_prefix(result.ptr - text.data());
 	return true;
 }
 
-std::vector<SpeciesInfo> EBirdChecklistParser::MergeLists(const std::vector<std::vector<SpeciesInfo>>& lists)
+std::vector<SpeciesView> EBirdChecklistParser::MergeLists(const std::vector<std::vector<SpeciesView>>& lists)
 {
-	std::vector<SpeciesInfo> mergedList(lists.front());
+	std::vector<SpeciesView> mergedList(lists.front());
+	if (lists.size() == 1)
+		return mergedList;
+		
+	std::unordered_map<unsigned int, std::vector<SpeciesView>::size_type> positions;// Taxon index to position in merged list
+	for (std::vector<SpeciesView>::size_type i = 0; i < mergedList.size(); ++i)
+		positions.emplace(mergedList[i].taxonIndex, i);
+		
 	for (unsigned int i = 1; i < lists.size(); ++i)
 	{
 		for (const auto& s : lists[i])
 		{
-			bool found(false);
-			for (auto& m : mergedList)
+			const auto inserted(positions.emplace(s.taxonIndex, mergedList.size()));
+			if (inserted.second)
+				mergedList.push_back(s);
+			else
 			{
-				if (s.name == m.name)
-				{
-					// NOTE:  If a pair of shared checklists both contian an entry for a species, but have
-					// different counts, only the count for the checklist whose link is being viewed is shown
-					// (i.e. no additional counts are shown in "additional species" lists at the bottom of the page).
-					m.count = std::max(m.count, s.count);
-					found = true;
-					break;
-				}
+				// NOTE:  If a pair of shared checklists both contian an entry for a species, but have
+				// different counts, only the count for the checklist whose link is being viewed is shown
+				// (i.e. no additional counts are shown in "additional species" lists at the bottom of the page).
+				auto& m(mergedList[inserted.first->second]);
+				m.count = std::max(m.count, s.count);
 			}
-			
-			if (!found)
-				mergedList.push_back(s);
 		}
 	}
 	
 	return mergedList;
 }
+
+void EBirdChecklistParser::SetUnmatchedNamesWarning(const SpeciesListState& state)
+{
+	if (state.unmatchedNames.empty())
+		return;
+		
+	// Each name is listed once, in the order it appears on the page
+	errorString = "Skipped species which aren't in the taxonomy:";
+	std::unordered_set<std::string_view> listedNames;
+	for (const auto& name : state.unmatchedNames)
+	{
+		if (listedNames.insert(name).second)
+			errorString.append("\n  " + name);
+	}
+}
+
+ChecklistInfo ChecklistView::ToChecklistInfo() const
+{
+	ChecklistInfo info;
+	info.identifier.assign(identifier);
+	info.birders.assign(birders.begin(), birders.end());
+	info.location.assign(location);
+	info.distance = distance;
+	info.duration = duration;
+	info.day = day;
+	info.month = month;
+	info.year = year;
+	
+	info.species.resize(species.size());
+	for (unsigned int i = 0; i < species.size(); ++i)
+	{
+		info.species[i].name.assign(species[i].name);
+		info.species[i].count = species[i].count;
+		info.species[i].taxonomicOrder = species[i].taxonomicOrder;
+		info.species[i].taxonIndex = species[i].taxonIndex;
+	}
+	
+	return info;
+}
+
+ChecklistView ChecklistView::FromChecklistInfo(std::shared_ptr<const ChecklistInfo> info)
+{
+	ChecklistView view;
+	view.identifier = info->identifier;
+	view.birders.assign(info->birders.begin(), info->birders.end());
+	view.location = info->location;
+	view.distance = info->distance;
+	view.duration = info->duration;
+	view.day = info->day;
+	view.month = info->month;
+	view.year = info->year;
+	
+	view.species.resize(info->species.size());
+	for (unsigned int i = 0; i < info->species.size(); ++i)
+	{
+		view.species[i].name = info->species[i].name;
+		view.species[i].count = info->species[i].count;
+		view.species[i].taxonomicOrder = info->species[i].taxonomicOrder;
+		view.species[i].taxonIndex = info->species[i].taxonIndex;
+	}
+	
+	view.storage = std::move(info);
+	return view;
+}
@@ -8,13 +8,17 @@
 
 // Local headers
 #include "eBirdCompiler.h"
+#include "patternSearcher.h"
 
 // Standard C++ headers
 #include <vector>
 #include <string>
+#include <string_view>
+#include <memory>
 
 // Local forward declarations
 class TaxonomyOrder;
+class HTMLTagScanner;
 
 struct ChecklistInfo
 {
@@ -31,18 +35,77 @@ struct ChecklistInfo
 	std::vector<SpeciesInfo> species;
 };
 
+// Alternatives to SpeciesInfo and ChecklistInfo which avoid copying text.  Text fields are views into the
+// storage (normally the page that was parsed), which is kept alive by the ChecklistView.
+struct SpeciesView
+{
+	std::string_view name;
+	unsigned int count;
+	unsigned int taxonomicOrder;
+	unsigned int taxonIndex;// Identifies the taxon, so it can be used in place of the name for comparisons
+};
+
+struct ChecklistView
+{
+	std::shared_ptr<const void> storage;
+	
+	std::string_view identifier;
+	std::vector<std::string_view> birders;
+	std::string_view location;
+	double distance;// [km]
+	double duration;// [min]
+	
+	unsigned int day;
+	unsigned int month;
+	unsigned int year;
+	
+	std::vector<SpeciesView> species;
+	
+	ChecklistInfo ToChecklistInfo() const;
+	static ChecklistView FromChecklistInfo(std::shared_ptr<const ChecklistInfo> info);
+};
+
 class EBirdChecklistParser
 {
 public:
-	EBirdChecklistParser(TaxonomyOrder& taxonomy) : taxonomy(taxonomy) {}
+	EBirdChecklistParser(const TaxonomyOrder& taxonomy) : taxonomy(taxonomy) {}
 	
 	bool Parse(const std::string& html, ChecklistInfo& info);
+	bool Parse(std::shared_ptr<const std::string> html, ChecklistView& view);// View takes shared ownership of the page
+	
+	// Incremental parsing, for pages which arrive in pieces (i.e. while downloading).  Each tag is read as soon as it is
+	// complete, and only the unread tail of the page is kept, so the whole page is never held in memory.  Feed() returns
+	// false once the page can't be parsed; FinishStream() must be called after the last piece.
+	void BeginStream();
+	bool Feed(std::string_view data);
+	bool FinishStream(ChecklistInfo& info);
+	bool IsStreamComplete() const { return stage == Stage::Done; }// Remainder of the page isn't needed
+	
+	// After a successful parse, a warning (if not empty) listing species which were skipped because they aren't in the taxonomy
 	std::string GetErrorString() const { return errorString; }
 	
 private:
 	std::string errorString;
 
-	TaxonomyOrder& taxonomy;
+	const TaxonomyOrder& taxonomy;
+	
+	static const PatternSearcher identifierTagStart;
+	static const PatternSearcher dateTagStart;
+	static const PatternSearcher locationTag;
+	static const PatternSearcher ownerTag;
+	static const PatternSearcher additionalBirdersTag;
+	static const PatternSearcher breadcrumbsTag;
+	static const PatternSearcher smallSpanTag;
+	static const PatternSearcher spanTag;
+	static const PatternSearcher protocolStartTag;
+	static const PatternSearcher durationStartTag;
+	static const PatternSearcher distanceStartTag;
+	static const PatternSearcher listStartTag;
+	static const PatternSearcher additionalSpeciesTag;
+	static const PatternSearcher sectionStartTag;
+	static const PatternSearcher speciesNameStartTag;
+	static const PatternSearcher countStartTag;
+	static const std::string_view::size_type lookahead;// Longest pattern compared at a tag
 	
 	enum class Protocol
 	{
@@ -52,21 +115,84 @@ private:
 		Other
 	};
 	
-	bool ExtractIdentifier(const std::string& html, std::string::size_type& position, std::string& identifier);
-	bool ExtractDate(const std::string& html, std::string::size_type& position, ChecklistInfo& info);
-	bool ExtractLocation(const std::string& html, std::string::size_type& position, std::string& location);
-	bool ExtractBirders(const std::string& html, std::string::size_type& position, std::vector<std::string>& birders);
-	bool ExtractProtocol(const std::string& html, std::string::size_type& position, Protocol& protocol);
-	bool ExtractDuration(const std::string& html, std::string::size_type& position, double& duration);
-	bool ExtractDistance(const std::string& html, std::string::size_type& position, double& distance);
-	bool ExtractSpeciesList(const std::string& html, std::string::size_type& position, std::vector<SpeciesInfo>& species);
-	bool ExtractSpeciesInfo(const std::string& html, std::string::size_type& position, SpeciesInfo& info, const std::string::size_type& maxPosition);
-	
-	static bool ExtractTextBetweenTags(const std::string& html, const std::string& startTag, const std::string& endTag, std::string& token, std::string::size_type& position, const std::string::size_type& maxPosition = std::string::npos);
-	static bool MoveToEndOfTag(const std::string& html, const std::string& tag, std::string::size_type& position, const std::string::size_type& maxPosition = std::string::npos);
-	static std::string::size_type FindEndTag(const std::string& html, std::string::size_type position, const std::string& tag);
-	
-	static std::vector<SpeciesInfo> MergeLists(const std::vector<std::vector<SpeciesInfo>>& lists);
+	bool ParseView(std::string_view html, ChecklistView& view);
+	
+	bool ExtractIdentifier(HTMLTagScanner& scanner, std::string_view& identifier);
+	bool ExtractDate(HTMLTagScanner& scanner, ChecklistView& view);
+	bool ExtractLocation(HTMLTagScanner& scanner, std::string_view& location);
+	bool ExtractBirders(HTMLTagScanner& scanner, std::vector<std::string_view>& birders);
+	bool ExtractProtocol(HTMLTagScanner& scanner, Protocol& protocol);
+	bool ExtractDuration(HTMLTagScanner& scanner, double& duration);
+	bool ExtractDistance(HTMLTagScanner& scanner, double& distance);
+	bool ExtractSpeciesList(HTMLTagScanner& scanner, std::vector<SpeciesView>& species);
+	
+	static bool ParseDate(std::string_view token, unsigned int& year, unsigned int& month, unsigned int& day);
+	static Protocol ParseProtocol(std::string_view token);
+	bool ParseDuration(std::string_view token, double& duration);
+	bool ParseDistance(std::string_view token, double& distance);
+	
+	// The species list is read one tag at a time by both the whole page and incremental parsers
+	struct SpeciesListState
+	{
+		std::vector<std::vector<SpeciesView>> lists = std::vector<std::vector<SpeciesView>>(1);
+		SpeciesView info;
+		bool inSection = false;
+		bool foundName = false;
+		bool foundCount = false;
+		bool expectingCount = false;
+		bool skippingList = false;
+		unsigned int depth = 0;
+		std::vector<std::string> unmatchedNames;// Copied, since the page text is discarded as we go when parsing incrementally
+	};
+	
+	enum class TagResult
+	{
+		Continue,
+		Finished,
+		Incomplete// Need more of the page before this tag can be read
+	};
+	
+	TagResult ReadSpeciesTag(HTMLTagScanner& scanner, SpeciesListState& state, const bool& moreToCome) const;
+	
+	// Incremental parser state
+	enum class Stage
+	{
+		Identifier,
+		Date,
+		Location,
+		LocationName,
+		Owner,
+		OwnerName,
+		AdditionalBirders,
+		Breadcrumbs,
+		AdditionalBirderNames,
+		Protocol,
+		Duration,
+		Distance,
+		ListStart,
+		SpeciesList,
+		Done,
+		Failed
+	};
+	
+	bool streaming = false;
+	Stage stage = Stage::Identifier;
+	std::string pending;// Unread tail of the page
+	ChecklistInfo streamInfo;
+	Protocol streamProtocol = Protocol::Other;
+	SpeciesListState streamSpecies;
+	
+	bool ReadPending(const bool& moreToCome);
+	TagResult ReadStreamTag(HTMLTagScanner& scanner, const bool& moreToCome);
+	void Fail();
+	std::string GetStageErrorString() const;
+	
+	// Skip leading whitespace and remove the number from the front of text
+	static bool ParseNumber(std::string_view& text, double& value);
+	static bool ParseNumber(std::string_view& text, unsigned int& value);
+	
+	static std::vector<SpeciesView> MergeLists(const std::vector<std::vector<SpeciesView>>& lists);
+	void SetUnmatchedNamesWarning(const SpeciesListState& state);
 };
 
 #endif// EBIRD_CHECKLIST_PARSER_H_
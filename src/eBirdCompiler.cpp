@@ -7,8 +7,13 @@
 #include "eBirdCompiler.h"
 #include "eBirdChecklistParser.h"
 #include "htmlRetriever.h"
-#include "robotsParser.h"
+#include "robotsCache.h"
 #include "taxonomyOrder.h"
+#include "sharedTaxonomy.h"
+#include "boundedQueue.h"
+#include "checklistCache.h"
+#include "summaryAggregator.h"
+#include "instrumentation.h"
 
 // Standard C++ headers
 #include <sstream>
@@ -18,116 +23,493 @@
 #include <cassert>
 #include <cmath>
 #include <map>
+#include <thread>
+#include <mutex>
+#include <atomic>
 
 const std::string EBirdCompiler::userAgent("eBird Compiler");
 const std::string EBirdCompiler::taxonFileName("eBird_Taxonomy_v2019.csv");
+const std::string EBirdCompiler::httpCacheDirectory("httpCache");
+const std::chrono::seconds EBirdCompiler::httpCacheTimeToLive(std::chrono::minutes(10));
+const std::uintmax_t EBirdCompiler::httpCacheMaxSize(200 * 1024 * 1024);
+const std::string EBirdCompiler::checklistCacheFileName("checklists.bin");
+const std::size_t EBirdCompiler::checklistCacheMaxRecords(10000);
+const std::string EBirdCompiler::robotsCacheDirectory("robotsCache");
+const std::chrono::seconds EBirdCompiler::robotsCacheTimeToLive(std::chrono::hours(24));
+
+EBirdCompiler::EBirdCompiler() : EBirdCompiler(CreateSharedResources())
+{
+}
+
+EBirdCompiler::EBirdCompiler(std::shared_ptr<SharedTaxonomy> taxonomy) : EBirdCompiler([&taxonomy]()
+	{
+		auto resources(CreateSharedResources());
+		resources.taxonomy = taxonomy;
+		return resources;
+	}())
+{
+}
+
+EBirdCompiler::EBirdCompiler(const SharedResources& resources) : taxonomy(resources.taxonomy),
+	httpCache(resources.httpCache), checklistCache(resources.checklistCache), rateLimiter(resources.rateLimiter),
+	robotsCache(resources.robotsCache), fetcherFactory(resources.fetcherFactory), aggregator(std::make_unique<SummaryAggregator>())
+{
+	assert(taxonomy && httpCache && checklistCache && rateLimiter && robotsCache);
+	taxonomy->BeginLoad();
+}
+
+EBirdCompiler::~EBirdCompiler() = default;
+
+std::shared_ptr<SharedTaxonomy> EBirdCompiler::CreateSharedTaxonomy()
+{
+	return std::make_shared<SharedTaxonomy>(userAgent, taxonFileName);
+}
+
+std::shared_ptr<SharedTaxonomy> EBirdCompiler::CreateSharedTaxonomy(const std::string& fileName, const std::vector<std::string>& previousFileNames)
+{
+	return std::make_shared<SharedTaxonomy>(userAgent, fileName, previousFileNames);
+}
+
+EBirdCompiler::SharedResources EBirdCompiler::CreateSharedResources()
+{
+	SharedResources resources;
+	resources.taxonomy = CreateSharedTaxonomy();
+	resources.httpCache = std::make_shared<HTTPCache>(httpCacheDirectory, httpCacheTimeToLive, httpCacheMaxSize);
+	resources.checklistCache = std::make_shared<ChecklistCache>(checklistCacheFileName, checklistCacheMaxRecords);
+	resources.rateLimiter = std::make_shared<HostRateLimiter>(HostRateLimiter::Clock::duration(0));
+	resources.robotsCache = std::make_shared<RobotsCache>(robotsCacheDirectory, robotsCacheTimeToLive);
+	return resources;
+}
+
+void EBirdCompiler::SetTaxonomy(std::shared_ptr<SharedTaxonomy> taxonomy)
+{
+	assert(taxonomy);
+	this->taxonomy = taxonomy;
+	this->taxonomy->BeginLoad();
+}
 
-#include <iostream>
 bool EBirdCompiler::Update(const std::string& checklistString)
 {
+	Instrumentation::Span span("update");
 	errorString.clear();
-	summary = SummaryInfo();
+	transferStatistics.clear();
 	
-	std::set<std::string> urlList;// Use set to avoid duplicates
-	std::string url;
-	std::istringstream ss(checklistString);
-	while (ss >> url)
-	{
-		if (url.find("ebird.org/") == std::string::npos && url.front() == 'S')// Allow checkilist IDs to be used and generate full URL automatically
-			urlList.insert("https://ebird.org/checklist/" + url);
-		else if (!url.empty())
-			urlList.insert(url);
-	}
-		
-	if (urlList.empty())
+	std::set<std::string> urlList;
+	if (!ExtractURLs(checklistString, urlList))
 	{
 		errorString = "Failed to find any URLs";
 		return false;
 	}
 	
-	TaxonomyOrder taxonomicOrder(userAgent);
-	if (!taxonomicOrder.Parse(taxonFileName))
-	{
-		errorString = taxonomicOrder.GetErrorString();
+	const auto taxonomicOrder(taxonomy->Get(errorString));
+	if (!taxonomicOrder)
 		return false;
+		
+	// Checklists compiled against a different taxonomy may have stale taxonomic order, so start over
+	if (taxonomicOrder != aggregator->GetTaxonomy())
+		aggregator->SetTaxonomy(taxonomicOrder);
+	
+	// Only checklists which weren't part of the last summary need to be downloaded and parsed
+	std::vector<std::string> newURLs;
+	for (const auto& u : urlList)
+	{
+		if (!aggregator->Contains(u))
+			newURLs.push_back(u);
 	}
 	
-	HTMLRetriever htmlClient(userAgent);
+	if (!newURLs.empty() && !AddChecklists(newURLs, AggregatorList(newURLs.size(), { aggregator.get() }), *taxonomicOrder))
+		return false;
+		
+	for (const auto& key : aggregator->GetKeys())
+	{
+		if (urlList.find(key) == urlList.end())
+			aggregator->Remove(key);
+	}
 	
-	const auto baseURL(RobotsParser::GetBaseURL(*urlList.begin()));
-	RobotsParser robotsTxtParser(htmlClient, baseURL);
-	std::chrono::steady_clock::duration crawlDelay;
-	if (robotsTxtParser.RetrieveRobotsTxt())
-		crawlDelay = robotsTxtParser.GetCrawlDelay();
-	else
-		crawlDelay = std::chrono::seconds(1);// Default value
+	lists.clear();
+	std::string warning;
+	summary = BuildSummary(*aggregator, warning);
+	errorString.append(warning);// After any warnings from parsing
+	return true;
+}
+
+bool EBirdCompiler::Update(const std::vector<NamedList>& namedLists)
+{
+	Instrumentation::Span span("update");
+	errorString.clear();
+	transferStatistics.clear();
 	
-	htmlClient.SetCrawlDelay(crawlDelay);
-	std::vector<ChecklistInfo> checklistInfo;
-	for (const auto& u : urlList)
+	std::vector<std::set<std::string>> urlLists(namedLists.size());
+	std::set<std::string> allURLs;
+	std::set<std::string> names;
+	for (unsigned int i = 0; i < namedLists.size(); ++i)
 	{
-		std::string html;
-		if (!htmlClient.GetHTML(u, html))
+		if (!names.insert(namedLists[i].name).second)
 		{
-			errorString = "Failed to download checklist from " + u;
+			errorString = "More than one list is named '" + namedLists[i].name + "'";
 			return false;
 		}
-		
-		checklistInfo.push_back(ChecklistInfo());
-		EBirdChecklistParser parser(taxonomicOrder);
-		if (!parser.Parse(html, checklistInfo.back()))
+		else if (!ExtractURLs(namedLists[i].checklistString, urlLists[i]))
 		{
-			errorString = parser.GetErrorString();
+			errorString = "Failed to find any URLs in '" + namedLists[i].name + "'";
 			return false;
 		}
+		
+		allURLs.insert(urlLists[i].begin(), urlLists[i].end());
 	}
-
-	std::set<std::string> locationSet;
-	unsigned int anonUserCount(0);
-	std::map<unsigned int, std::vector<std::string>> checklistsByDateCode;
-	for (const auto& ci : checklistInfo)
+	
+	if (allURLs.empty())
 	{
-		summary.totalDistance += ci.distance;
-		summary.totalTime += ci.duration;
+		errorString = "Failed to find any URLs";
+		return false;
+	}
+	
+	const auto taxonomicOrder(taxonomy->Get(errorString));
+	if (!taxonomicOrder)
+		return false;
+		
+	if (taxonomicOrder != aggregator->GetTaxonomy())
+		aggregator->SetTaxonomy(taxonomicOrder);
 		
-		const auto dateCode(GetDateCode(ci));
-		checklistsByDateCode[dateCode].push_back(ci.identifier);
+	// Lists are matched with those from the last update by name, so unchanged lists don't need any work.
+	// Nothing is moved out of the existing lists until everything has been added successfully.
+	std::vector<ListSummary*> previousLists(namedLists.size(), nullptr);
+	std::vector<std::unique_ptr<SummaryAggregator>> createdAggregators(namedLists.size());
+	std::vector<SummaryAggregator*> listAggregators(namedLists.size());
+	for (unsigned int i = 0; i < namedLists.size(); ++i)
+	{
+		const auto existing(std::find_if(lists.begin(), lists.end(), [&namedLists, i](const ListSummary& l)
+		{
+			return l.name == namedLists[i].name;
+		}));
 		
-		for (const auto& b : ci.birders)
+		if (existing != lists.end())
 		{
-			if (std::find(summary.participants.begin(), summary.participants.end(), b) == summary.participants.end())
-				summary.participants.push_back(b);
+			previousLists[i] = &*existing;
+			listAggregators[i] = existing->aggregator.get();
+		}
+		else
+		{
+			createdAggregators[i] = std::make_unique<SummaryAggregator>();
+			listAggregators[i] = createdAggregators[i].get();
 		}
 		
-		if (std::find(ci.birders.begin(), ci.birders.end(), std::string("Anonymous eBirder")) != ci.birders.end())
-			++anonUserCount;
+		if (taxonomicOrder != listAggregators[i]->GetTaxonomy())
+			listAggregators[i]->SetTaxonomy(taxonomicOrder);
+	}
+	
+	// Each checklist is downloaded and parsed once, then added to every aggregator which needs it
+	std::vector<std::string> newURLs;
+	AggregatorList destinations;
+	for (const auto& u : allURLs)
+	{
+		std::vector<SummaryAggregator*> urlDestinations;
+		if (!aggregator->Contains(u))
+			urlDestinations.push_back(aggregator.get());
 			
-		locationSet.insert(ci.location);
+		for (unsigned int i = 0; i < namedLists.size(); ++i)
+		{
+			if (urlLists[i].find(u) != urlLists[i].end() && !listAggregators[i]->Contains(u))
+				urlDestinations.push_back(listAggregators[i]);
+		}
 		
-		for (const auto& checklistSpecies : ci.species)
+		if (!urlDestinations.empty())
 		{
-			bool found(false);
-			for (auto& summarySpecies : summary.species)
+			newURLs.push_back(u);
+			destinations.push_back(std::move(urlDestinations));
+		}
+	}
+	
+	if (!newURLs.empty() && !AddChecklists(newURLs, destinations, *taxonomicOrder))
+		return false;
+		
+	for (const auto& key : aggregator->GetKeys())
+	{
+		if (allURLs.find(key) == allURLs.end())
+			aggregator->Remove(key);
+	}
+	
+	std::vector<ListSummary> newLists(namedLists.size());
+	std::string listWarnings;
+	for (unsigned int i = 0; i < namedLists.size(); ++i)
+	{
+		for (const auto& key : listAggregators[i]->GetKeys())
+		{
+			if (urlLists[i].find(key) == urlLists[i].end())
+				listAggregators[i]->Remove(key);
+		}
+		
+		newLists[i].name = namedLists[i].name;
+		if (previousLists[i])
+			newLists[i].aggregator = std::move(previousLists[i]->aggregator);
+		else
+			newLists[i].aggregator = std::move(createdAggregators[i]);
+		
+		std::string warning;
+		newLists[i].summary = BuildSummary(*newLists[i].aggregator, warning);
+		if (!warning.empty())
+			listWarnings.append(newLists[i].name + ":  " + warning);
+	}
+	
+	lists = std::move(newLists);
+	
+	// Date mismatches within a list are more specific, so only report the grand total's if there are none
+	std::string warning;
+	summary = BuildSummary(*aggregator, warning);
+	errorString.append(listWarnings.empty() ? warning : listWarnings);// After any warnings from parsing
+		
+	return true;
+}
+
+bool EBirdCompiler::ExtractURLs(const std::string& checklistString, std::set<std::string>& urlList)
+{
+	std::string url;
+	std::istringstream ss(checklistString);
+	while (ss >> url)
+	{
+		if (url.find("ebird.org/") == std::string::npos && url.front() == 'S')// Allow checkilist IDs to be used and generate full URL automatically
+			urlList.insert("https://ebird.org/checklist/" + url);
+		else if (!url.empty())
+			urlList.insert(url);
+	}
+	
+	return !urlList.empty();
+}
+
+std::unique_ptr<PageFetcher> EBirdCompiler::CreateFetcher() const
+{
+	if (fetcherFactory)
+		return fetcherFactory();
+		
+	SharedResources resources;
+	resources.httpCache = httpCache;
+	resources.rateLimiter = rateLimiter;
+	resources.robotsCache = robotsCache;
+	return CreateRetriever(resources);
+}
+
+std::unique_ptr<PageFetcher> EBirdCompiler::CreateRetriever(const SharedResources& resources)
+{
+	auto htmlClient(std::make_unique<HTMLRetriever>(userAgent));
+	htmlClient->SetCache(resources.httpCache);
+	htmlClient->SetRateLimiter(resources.rateLimiter);
+	htmlClient->SetRobotsCache(resources.robotsCache);// Also sets the crawl delay for each host
+	return htmlClient;
+}
+
+bool EBirdCompiler::AddChecklists(const std::vector<std::string>& urls, const AggregatorList& destinations, const TaxonomyOrder& taxonomicOrder)
+{
+	const auto fetcher(CreateFetcher());
+	
+	// Pages downloaded from the server are parsed on the download thread (this one) as they arrive, so they're never
+	// held whole.  Pages from the cache arrive whole, and flow to a pool of parser threads.  Parsed checklists flow to
+	// a single aggregator thread.  The queues are bounded, so only a handful of pages are held in memory at once.
+	const unsigned int parserCount(std::max(std::thread::hardware_concurrency(), 1U));
+	struct Page
+	{
+		std::vector<std::string>::size_type index;
+		std::string html;
+	};
+	
+	struct ParsedChecklist
+	{
+		std::vector<std::string>::size_type index;
+		ChecklistView checklist;// Refers to the page (or cached record), which it keeps alive until aggregated
+	};
+	
+	BoundedQueue<Page> pageQueue(2 * parserCount);
+	BoundedQueue<ParsedChecklist> checklistQueue(2 * parserCount);
+	
+	std::mutex pipelineErrorMutex;
+	std::string pipelineError;
+	std::map<std::vector<std::string>::size_type, std::string> parseWarnings;// Keyed by URL index, so they're reported in order
+	std::atomic<bool> pipelineFailed(false);
+	auto setPipelineError([&pipelineErrorMutex, &pipelineError, &pipelineFailed, &pageQueue](const std::string& message)
+	{
+		{
+			std::lock_guard<std::mutex> lock(pipelineErrorMutex);
+			if (pipelineError.empty())
+				pipelineError = message;
+		}
+		
+		pipelineFailed = true;
+		pageQueue.Close();// Causes the download handler to cancel remaining transfers
+	});
+	
+	// Checklists with warnings aren't stored in the checklist cache, so the warning is repeated each time they're compiled
+	auto addParseWarning([&pipelineErrorMutex, &parseWarnings](const std::vector<std::string>::size_type& index, const std::string& warning)
+	{
+		std::lock_guard<std::mutex> lock(pipelineErrorMutex);
+		parseWarnings[index] = warning;
+	});
+	
+	std::vector<std::thread> parsers;
+	for (unsigned int i = 0; i < parserCount; ++i)
+	{
+		parsers.emplace_back([this, &urls, &pageQueue, &checklistQueue, &pipelineFailed, &setPipelineError, &addParseWarning, &taxonomicOrder]()
+		{
+			Page page;
+			while (!pipelineFailed && pageQueue.Pop(page))
 			{
-				if (summarySpecies.name == checklistSpecies.name)
+				// Pages that haven't changed since we last parsed them are pulled from the store instead
+				const std::string checklistID(ChecklistCache::GetChecklistID(urls[page.index]));
+				const std::uint64_t htmlHash(ChecklistCache::Hash(page.html));
+				ParsedChecklist parsed;
+				parsed.index = page.index;
+				auto cachedInfo(std::make_shared<ChecklistInfo>());
+				if (checklistCache->Find(checklistID, htmlHash, taxonomicOrder, *cachedInfo))
 				{
-					summarySpecies.count += checklistSpecies.count;
-					found = true;
-					break;
+					Instrumentation::Count("checklist cache hits");
+					parsed.checklist = ChecklistView::FromChecklistInfo(std::move(cachedInfo));
 				}
+				else
+				{
+					Instrumentation::Span parseSpan("parse");
+					EBirdChecklistParser parser(taxonomicOrder);
+					if (!parser.Parse(std::make_shared<const std::string>(std::move(page.html)), parsed.checklist))
+					{
+						setPipelineError(parser.GetErrorString());
+						break;
+					}
+					parseSpan.End();
+					
+					if (!parser.GetErrorString().empty())
+						addParseWarning(page.index, parser.GetErrorString());
+					else
+						checklistCache->Store(checklistID, htmlHash, taxonomicOrder, parsed.checklist);
+				}
+				
+				Instrumentation::Count("pages");
+				Instrumentation::Count("species rows", parsed.checklist.species.size());
+				
+				if (!checklistQueue.Push(std::move(parsed)))
+					break;
 			}
+		});
+	}
+	
+	std::thread aggregatorThread([&urls, &destinations, &checklistQueue]()
+	{
+		ParsedChecklist parsed;
+		while (checklistQueue.Pop(parsed))
+		{
+			Instrumentation::Span span("aggregate");
+			for (auto& a : destinations[parsed.index])
+				a->Add(urls[parsed.index], parsed.checklist);
+		}
+	});
+	
+	struct StreamedPage
+	{
+		std::unique_ptr<EBirdChecklistParser> parser;
+		std::uint64_t htmlHash = ChecklistCache::initialHash;
+		bool parseFailed = false;
+	};
+	
+	std::map<std::vector<std::string>::size_type, StreamedPage> streamedPages;// Transfers in progress
+	auto chunkHandler([&streamedPages, &taxonomicOrder](const std::vector<std::string>::size_type& index, std::string_view data)
+	{
+		StreamedPage& page(streamedPages[index]);
+		if (!page.parser)
+		{
+			page.parser = std::make_unique<EBirdChecklistParser>(taxonomicOrder);
+			page.parser->BeginStream();
+		}
+		
+		Instrumentation::Span span("parse (streamed)");
+		page.htmlHash = ChecklistCache::Hash(data, page.htmlHash);
+		page.parseFailed = !page.parser->Feed(data);
+		return !page.parseFailed;// No sense downloading the rest
+	});
+	
+	auto handler([this, &urls, &pageQueue, &checklistQueue, &streamedPages, &pipelineFailed, &setPipelineError, &addParseWarning, &taxonomicOrder](const std::vector<std::string>::size_type& index, const bool& success, std::string& html)
+	{
+		const auto streamed(streamedPages.find(index));
+		if (!success)
+		{
+			if (streamed != streamedPages.end() && streamed->second.parseFailed)
+				setPipelineError(streamed->second.parser->GetErrorString());
+			else
+				setPipelineError("Failed to download checklist from " + urls[index]);
+			return false;
+		}
+		
+		if (streamed != streamedPages.end())
+		{
+			Instrumentation::Span span("parse (streamed)");
+			auto info(std::make_shared<ChecklistInfo>());
+			if (!streamed->second.parser->FinishStream(*info))
+			{
+				setPipelineError(streamed->second.parser->GetErrorString());
+				return false;
+			}
+			span.End();
+			
+			Instrumentation::Count("pages");
+			Instrumentation::Count("species rows", info->species.size());
 			
-			if (!found)
-				summary.species.push_back(checklistSpecies);
+			if (!streamed->second.parser->GetErrorString().empty())
+				addParseWarning(index, streamed->second.parser->GetErrorString());
+			else
+				checklistCache->Store(ChecklistCache::GetChecklistID(urls[index]), streamed->second.htmlHash, taxonomicOrder, *info);
+			streamedPages.erase(streamed);
+			
+			ParsedChecklist parsed;
+			parsed.index = index;
+			parsed.checklist = ChecklistView::FromChecklistInfo(std::move(info));
+			return !pipelineFailed && checklistQueue.Push(std::move(parsed));
 		}
+		
+		Page page;
+		page.index = index;
+		page.html = std::move(html);
+		return pageQueue.Push(std::move(page));// Blocks while parsers catch up
+	});
+	
+	const bool downloadSucceeded(fetcher->GetHTML(urls, handler, chunkHandler));
+	transferStatistics.insert(transferStatistics.end(), fetcher->GetStatistics().begin(), fetcher->GetStatistics().end());
+	pageQueue.Close();
+	for (auto& p : parsers)
+		p.join();
+	checklistQueue.Close();
+	aggregatorThread.join();
+	checklistCache->Save();// Not an error if this fails - we'll just parse again next time
+	
+	if (pipelineError.empty() && downloadSucceeded)
+	{
+		for (const auto& w : parseWarnings)
+			errorString.append(ChecklistCache::GetChecklistID(urls[w.first]) + ":  " + w.second + '\n');
+		return true;
+	}
+		
+	if (!pipelineError.empty())
+		errorString = pipelineError;
+	else
+		errorString = "Failed to download checklists";
+		
+	// Back out anything we added so the previous summary remains intact
+	for (unsigned int i = 0; i < urls.size(); ++i)
+	{
+		for (auto& a : destinations[i])
+			a->Remove(urls[i]);
 	}
+		
+	return false;
+}
 
-	RemoveSubspeciesFromSummary();
-	SortTaxonomically(summary.species);
-	
-	summary.includesMoreThanOneAnonymousUser = anonUserCount > 1;
-	summary.locationCount = locationSet.size();
+EBirdCompiler::SummaryInfo EBirdCompiler::BuildSummary(const SummaryAggregator& source, std::string& warning)
+{
+	Instrumentation::Span span("build summary");
+	SummaryInfo summary;
+	summary.participants = source.GetParticipants();
+	summary.includesMoreThanOneAnonymousUser = source.GetAnonymousChecklistCount() > 1;
+	summary.totalDistance = source.GetTotalDistance();
+	summary.totalTime = source.GetTotalTime();
+	summary.locationCount = source.GetLocationCount();
+	summary.species = source.GetSpecies();
 	
+	warning.clear();
+	const auto& checklistsByDateCode(source.GetChecklistsByDateCode());
 	if (checklistsByDateCode.size() > 1)
 	{
 		// Try to be helpful about reporting these potential errors:
@@ -135,7 +517,7 @@ bool EBirdCompiler::Update(const std::string& checklistString)
 		// - Otherwise, report the number of checklists given for each date
 		for (const auto& cl : checklistsByDateCode)
 		{
-			if (cl.second.size() > 0.8 * checklistInfo.size())
+			if (cl.second.size() > 0.8 * source.GetChecklistCount())
 			{
 				std::ostringstream ss;
 				ss << "The following checklists are not from the same date as the others:\n";
@@ -148,26 +530,51 @@ bool EBirdCompiler::Update(const std::string& checklistString)
 					}
 				}
 				
-				errorString = ss.str();
+				warning = ss.str();
 				break;
 			}
 		}
 		
-		if (errorString.empty())
+		if (warning.empty())
 		{
 			std::ostringstream ss;
 			ss << "Not all checklists are from the same date:\n";
 			for (const auto& cl : checklistsByDateCode)
-				ss << GetDateFromCode(cl.first) << " - " << cl.second.size() << " checklists\n";
-			errorString = ss.str();
+				ss << SummaryAggregator::GetDateFromCode(cl.first) << " - " << cl.second.size() << " checklists\n";
+			warning = ss.str();
 		}
 	}
 	
-	return true;
+	return summary;
 }
 
 std::string EBirdCompiler::GetSummaryString() const
 {
+	return FormatSummary(summary, aggregator->GetTaxonomy().get());
+}
+
+std::string EBirdCompiler::GetSummaryString(const std::string& listName) const
+{
+	for (const auto& l : lists)
+	{
+		if (l.name == listName)
+			return FormatSummary(l.summary, l.aggregator->GetTaxonomy().get());
+	}
+	
+	return std::string();
+}
+
+std::vector<std::string> EBirdCompiler::GetListNames() const
+{
+	std::vector<std::string> names;
+	for (const auto& l : lists)
+		names.push_back(l.name);
+	return names;
+}
+
+std::string EBirdCompiler::FormatSummary(const SummaryInfo& summary, const TaxonomyOrder* taxonomicOrder)
+{
+	Instrumentation::Span span("format summary");
 	unsigned int totalIndividuals(0);
 	for (const auto& s : summary.species)
 		totalIndividuals += s.count;
@@ -191,8 +598,9 @@ std::string EBirdCompiler::GetSummaryString() const
 	else
 		ss << timeMin << " min";
 		
-	unsigned int speciesCount, otherTaxaCount;
-	CountSpecies(summary.species, speciesCount, otherTaxaCount);
+	unsigned int speciesCount(0), otherTaxaCount(0);
+	if (taxonomicOrder)
+		CountSpecies(summary.species, *taxonomicOrder, speciesCount, otherTaxaCount);
 	ss<< "\n# Locations:     " << summary.locationCount
 		<< "\n# Species:       " << speciesCount;
 	if (otherTaxaCount > 0)
@@ -203,7 +611,7 @@ std::string EBirdCompiler::GetSummaryString() const
 	for (const auto& s : summary.species)
 		maxNameLength = std::max(maxNameLength, s.name.length());
 		
-	const unsigned int extraSpace([this]()
+	const unsigned int extraSpace([&summary]()
 	{
 		unsigned int maxLength(0);
 		for (const auto& s : summary.species)
@@ -229,87 +637,16 @@ std::string EBirdCompiler::GetSummaryString() const
 	return ss.str();
 }
 
-unsigned int EBirdCompiler::GetDateCode(const ChecklistInfo& info)
-{
-	assert(info.month > 0 && info.month <= 12);
-	assert(info.day > 0 && info.day <= 31);
-	assert(info.year > 1700);
-	return (info.year - 1700) + info.month * 1000 + info.day * 100000;
-}
-
-std::string EBirdCompiler::GetDateFromCode(const unsigned int& code)
-{
-	const unsigned int day(code / 100000);
-	const unsigned int month((code - day * 100000) / 1000);
-	const unsigned int year(code - day * 100000 - month * 1000 + 1700);
-	std::ostringstream ss;
-	ss << month << '/' << day << '/' << year;
-	return ss.str();
-}
-
-void EBirdCompiler::CountSpecies(const std::vector<SpeciesInfo>& species, unsigned int& speciesCount, unsigned int& otherTaxaCount)
+// Subspecies have already been rolled up into their parents, so each row is a distinct taxon
+void EBirdCompiler::CountSpecies(const std::vector<SpeciesInfo>& species, const TaxonomyOrder& taxonomicOrder, unsigned int& speciesCount, unsigned int& otherTaxaCount)
 {
-	std::set<std::string> fullSpecies;
-	std::set<std::string> otherTaxa;
-	
+	speciesCount = 0;
+	otherTaxaCount = 0;
 	for (const auto& s : species)
 	{
-		const auto cleanedName(StripSubspecies(s.name));
-		if (IsSpuhOrSlash(cleanedName))
-			otherTaxa.insert(cleanedName);
+		if (taxonomicOrder.CountsAsSpecies(s.taxonIndex))
+			++speciesCount;
 		else
-			fullSpecies.insert(cleanedName);
-	}
-	
-	speciesCount = fullSpecies.size();
-	otherTaxaCount = otherTaxa.size();
-}
-
-std::string EBirdCompiler::StripSubspecies(const std::string& name)
-{
-	const auto parenStart(name.find('('));
-	if (parenStart == std::string::npos)
-		return name;
-		
-	return name.substr(0, parenStart - 1);
-}
-
-bool EBirdCompiler::IsSpuhOrSlash(const std::string& name)
-{
-	const std::string spuh("sp.");
-	if (name.find(spuh) != std::string::npos)
-		return true;
-	else if (name.find('/') != std::string::npos)
-		return true;
-		
-	return false;
-}
-
-void EBirdCompiler::SortTaxonomically(std::vector<SpeciesInfo>& species)
-{
-	auto sortPredicate([](const SpeciesInfo& a, const SpeciesInfo& b)
-	{
-		return a.taxonomicOrder < b.taxonomicOrder;
-	});
-	
-	std::sort(species.begin(), species.end(), sortPredicate);
-}
-
-void EBirdCompiler::RemoveSubspeciesFromSummary()
-{
-	for (auto& s : summary.species)
-		s.name = StripSubspecies(s.name);
-		
-	for (unsigned int i = 0; i < summary.species.size(); ++i)
-	{
-		for (unsigned int j = i + 1; j < summary.species.size(); ++j)
-		{
-			if (summary.species[i].name == summary.species[j].name)
-			{
-				summary.species[i].count += summary.species[j].count;
-				summary.species.erase(summary.species.begin() + j);
-				--j;
-			}
-		}
+			++otherTaxaCount;
 	}
 }
@@ -6,34 +6,111 @@
 #ifndef EBIRD_COMPILER_H_
 #define EBIRD_COMPILER_H_
 
+// Local headers
+#include "transferStatistics.h"
+
 // Standard C++ headers
 #include <string>
 #include <vector>
+#include <memory>
+#include <set>
+#include <chrono>
+#include <functional>
+#include <cstdint>
 
 // Local forward declarations
-struct ChecklistInfo;
+class SharedTaxonomy;
+class TaxonomyOrder;
+class SummaryAggregator;
+class HTTPCache;
+class ChecklistCache;
+class HostRateLimiter;
+class RobotsCache;
+class PageFetcher;
 
 struct SpeciesInfo
 {
 	std::string name;
 	unsigned int count;
 	unsigned int taxonomicOrder;
+	unsigned int taxonIndex;// See TaxonomyOrder::GetTaxonIndex()
 };
 
 class EBirdCompiler
 {
 public:
+	// Everything which may be shared among several compilers, including compilers running at the same time
+	struct SharedResources
+	{
+		std::shared_ptr<SharedTaxonomy> taxonomy;
+		std::shared_ptr<HTTPCache> httpCache;
+		std::shared_ptr<ChecklistCache> checklistCache;
+		std::shared_ptr<HostRateLimiter> rateLimiter;// Holds concurrent compilers to one crawl delay per host
+		std::shared_ptr<RobotsCache> robotsCache;
+		
+		// Creates the fetcher for each update.  If not set, pages are downloaded with an HTMLRetriever using the caches,
+		// rate limiter and robots.txt rules above.
+		std::function<std::unique_ptr<PageFetcher>()> fetcherFactory;
+	};
+	
+	EBirdCompiler();// Owns a taxonomy, which begins loading immediately
+	explicit EBirdCompiler(std::shared_ptr<SharedTaxonomy> taxonomy);// Taxonomy may be shared among several compilers
+	explicit EBirdCompiler(const SharedResources& resources);
+	~EBirdCompiler();
+	
+	static std::shared_ptr<SharedTaxonomy> CreateSharedTaxonomy();
+	static std::shared_ptr<SharedTaxonomy> CreateSharedTaxonomy(const std::string& fileName, const std::vector<std::string>& previousFileNames);// See SharedTaxonomy
+	static std::string GetDefaultTaxonomyFileName() { return taxonFileName; }
+	static SharedResources CreateSharedResources();
+	
+	// The fetcher used when the resources don't include a fetcher factory (i.e. for wrapping in another fetcher)
+	static std::unique_ptr<PageFetcher> CreateRetriever(const SharedResources& resources);
+	
+	// Begins loading the new taxonomy; the next update compiles against it (not to be called during an update)
+	void SetTaxonomy(std::shared_ptr<SharedTaxonomy> taxonomy);
+	
 	bool Update(const std::string& checklistString);
 	
+	// Compiles several named lists together (e.g. the sectors of a count circle).  Checklists which appear in more
+	// than one list are only downloaded and parsed once.  GetSummaryString() then gives the grand total over every
+	// unique checklist, and GetSummaryString(name) gives the summary for a single list.
+	struct NamedList
+	{
+		std::string name;
+		std::string checklistString;
+	};
+	
+	bool Update(const std::vector<NamedList>& lists);
+	
 	std::string GetErrorString() const { return errorString; }
 	std::string GetSummaryString() const;
+	std::string GetSummaryString(const std::string& listName) const;// Empty if there is no list with that name
+	std::vector<std::string> GetListNames() const;
+	
+	// Requests sent to servers during the last update (pages served fresh from the cache aren't included)
+	const std::vector<TransferStatistics>& GetTransferStatistics() const { return transferStatistics; }
 
 private:
 	static const std::string userAgent;
 	static const std::string taxonFileName;
+	static const std::string httpCacheDirectory;
+	static const std::chrono::seconds httpCacheTimeToLive;
+	static const std::uintmax_t httpCacheMaxSize;// [bytes]
+	static const std::string checklistCacheFileName;
+	static const std::size_t checklistCacheMaxRecords;
+	static const std::string robotsCacheDirectory;
+	static const std::chrono::seconds robotsCacheTimeToLive;
+
+	std::shared_ptr<SharedTaxonomy> taxonomy;
+	std::shared_ptr<HTTPCache> httpCache;
+	std::shared_ptr<ChecklistCache> checklistCache;
+	std::shared_ptr<HostRateLimiter> rateLimiter;
+	std::shared_ptr<RobotsCache> robotsCache;
+	std::function<std::unique_ptr<PageFetcher>()> fetcherFactory;
 
 	std::string errorString;
 	std::vector<std::string> checklistURLs;
+	std::vector<TransferStatistics> transferStatistics;
 	
 	struct SummaryInfo
 	{
@@ -48,14 +125,30 @@ private:
 	
 	SummaryInfo summary;
 	
-	void RemoveSubspeciesFromSummary();
+	// Keeps each compiled checklist's contribution (keyed by URL) so subsequent updates only need to process changes
+	std::unique_ptr<SummaryAggregator> aggregator;
+	
+	// Only used by batch updates; the aggregator above holds the grand total
+	struct ListSummary
+	{
+		std::string name;
+		std::unique_ptr<SummaryAggregator> aggregator;
+		SummaryInfo summary;
+	};
+	
+	std::vector<ListSummary> lists;
+	
+	std::unique_ptr<PageFetcher> CreateFetcher() const;
+	
+	// Each parsed checklist is added to every aggregator listed for its URL
+	typedef std::vector<std::vector<SummaryAggregator*>> AggregatorList;
+	bool AddChecklists(const std::vector<std::string>& urls, const AggregatorList& destinations, const TaxonomyOrder& taxonomicOrder);
+	
+	static bool ExtractURLs(const std::string& checklistString, std::set<std::string>& urlList);
+	static SummaryInfo BuildSummary(const SummaryAggregator& source, std::string& warning);
+	static std::string FormatSummary(const SummaryInfo& summary, const TaxonomyOrder* taxonomicOrder);
 	
-	static unsigned int GetDateCode(const ChecklistInfo& info);
-	static std::string GetDateFromCode(const unsigned int& code);
-	static void CountSpecies(const std::vector<SpeciesInfo>& species, unsigned int& speciesCount, unsigned int& otherTaxaCount);
-	static std::string StripSubspecies(const std::string& name);
-	static bool IsSpuhOrSlash(const std::string& name);
-	static void SortTaxonomically(std::vector<SpeciesInfo>& species);
+	static void CountSpecies(const std::vector<SpeciesInfo>& species, const TaxonomyOrder& taxonomicOrder, unsigned int& speciesCount, unsigned int& otherTaxaCount);
 };
 
 #endif// EBIRD_COMPILER_H_
@@ -0,0 +1,131 @@
+// File:  hostRateLimiter.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Hands out request start times for each host, so concurrent fetchers collectively respect the
+//        crawl delay (with an optional burst allowance) and back off when a server asks us to.
+
+// Local headers
+#include "hostRateLimiter.h"
+
+// Standard C++ headers
+#include <thread>
+#include <algorithm>
+#include <cctype>
+
+const HostRateLimiter::Clock::duration HostRateLimiter::minBackoff(std::chrono::seconds(5));
+const HostRateLimiter::Clock::duration HostRateLimiter::maxBackoff(std::chrono::minutes(5));
+
+HostRateLimiter::HostRateLimiter(const Clock::duration& defaultDelay, const unsigned int& burst)
+	: defaultDelay(defaultDelay), burst(std::max(burst, 1U))
+{
+}
+
+void HostRateLimiter::SetDefaultDelay(const Clock::duration& delay)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	defaultDelay = delay;
+	for (auto& h : hosts)
+	{
+		if (!h.second.hasOwnDelay)
+			h.second.delay = delay;
+	}
+}
+
+void HostRateLimiter::SetDelay(const std::string& url, const Clock::duration& delay)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	HostState& state(GetState(url));
+	state.hasOwnDelay = true;
+	state.delay = delay;
+}
+
+void HostRateLimiter::SetBurst(const unsigned int& newBurst)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	burst = std::max(newBurst, 1U);
+}
+
+void HostRateLimiter::Wait(const std::string& url)
+{
+	Clock::time_point start;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		HostState& state(GetState(url));
+		start = std::max(GetEarliestStart(state), Clock::now());
+		Reserve(state, start);
+	}
+
+	std::this_thread::sleep_until(start);
+}
+
+bool HostRateLimiter::TryEnter(const std::string& url, Clock::duration& timeToWait)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	HostState& state(GetState(url));
+	const Clock::time_point now(Clock::now());
+	const Clock::time_point earliestStart(GetEarliestStart(state));
+	if (now < earliestStart)
+	{
+		timeToWait = earliestStart - now;
+		return false;
+	}
+
+	Reserve(state, now);
+	return true;
+}
+
+void HostRateLimiter::ReportResponse(const std::string& url, const long& responseCode, const Clock::duration& retryAfter)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	HostState& state(GetState(url));
+	if (!IsBackoffResponse(responseCode))
+	{
+		state.backoff = Clock::duration(0);
+		return;
+	}
+
+	if (retryAfter > Clock::duration(0))
+		state.backoff = std::min(retryAfter, maxBackoff);
+	else
+		state.backoff = std::min(std::max(2 * state.backoff, std::max(minBackoff, state.delay)), maxBackoff);
+
+	// Resume at the base rate rather than with a burst once the hold is over
+	const Clock::duration burstAllowance((burst - 1) * state.delay);
+	state.blockedUntil = std::max(state.blockedUntil, Clock::now() + state.backoff);
+	state.nextStart = std::max(state.nextStart, state.blockedUntil + burstAllowance);
+}
+
+std::string HostRateLimiter::GetHost(const std::string& url)
+{
+	std::string::size_type start(url.find("://"));
+	if (start == std::string::npos)
+		start = 0;
+	else
+		start += 3;
+
+	std::string host(url.substr(start, url.find_first_of("/?#", start) - start));
+	std::transform(host.begin(), host.end(), host.begin(), [](const unsigned char& c)
+	{
+		return static_cast<char>(std::tolower(c));
+	});
+
+	return host;
+}
+
+HostRateLimiter::HostState& HostRateLimiter::GetState(const std::string& url)
+{
+	const auto inserted(hosts.emplace(GetHost(url), HostState()));
+	if (inserted.second)
+		inserted.first->second.delay = defaultDelay;
+	return inserted.first->second;
+}
+
+HostRateLimiter::Clock::time_point HostRateLimiter::GetEarliestStart(const HostState& state) const
+{
+	return std::max(state.nextStart - (burst - 1) * state.delay, state.blockedUntil);
+}
+
+void HostRateLimiter::Reserve(HostState& state, const Clock::time_point& start) const
+{
+	state.nextStart = std::max(state.nextStart, start) + state.delay;
+}
@@ -0,0 +1,71 @@
+// File:  hostRateLimiter.h
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Hands out request start times for each host, so concurrent fetchers collectively respect the
+//        crawl delay (with an optional burst allowance) and back off when a server asks us to.
+
+#ifndef HOST_RATE_LIMITER_H_
+#define HOST_RATE_LIMITER_H_
+
+// Standard C++ headers
+#include <chrono>
+#include <string>
+#include <map>
+#include <mutex>
+
+class HostRateLimiter
+{
+public:
+	typedef std::chrono::steady_clock Clock;
+	explicit HostRateLimiter(const Clock::duration& defaultDelay, const unsigned int& burst = 1);
+
+	// The default delay applies to hosts without a delay of their own (i.e. those we haven't read robots.txt for)
+	void SetDefaultDelay(const Clock::duration& delay);
+	void SetDelay(const std::string& url, const Clock::duration& delay);
+
+	// Number of requests which may be sent back-to-back after a host has been idle
+	void SetBurst(const unsigned int& burst);
+
+	// Blocks until a request to the URL's host may be sent.  The slot is reserved under the lock, but we
+	// sleep without it, so other threads can reserve the following slots in the meantime.
+	void Wait(const std::string& url);
+
+	// Non-blocking alternative to Wait().  Returns true if a request may be sent now, otherwise sets timeToWait and returns false.
+	bool TryEnter(const std::string& url, Clock::duration& timeToWait);
+
+	// Should be called with the status of each response.  429 and 503 responses hold off all requests to the host,
+	// for the Retry-After duration if the server gave one (retryAfter > 0) or an increasing delay otherwise.
+	void ReportResponse(const std::string& url, const long& responseCode, const Clock::duration& retryAfter = Clock::duration(0));
+
+	static bool IsBackoffResponse(const long& responseCode) { return responseCode == 429 || responseCode == 503; }
+	static std::string GetHost(const std::string& url);
+
+private:
+	static const Clock::duration minBackoff;
+	static const Clock::duration maxBackoff;
+
+	Clock::duration defaultDelay;
+	unsigned int burst;
+
+	struct HostState
+	{
+		bool hasOwnDelay = false;
+		Clock::duration delay;
+
+		// Requests are permitted once the clock reaches nextStart less the burst allowance.  Each request pushes nextStart
+		// back by one delay, so the long term rate never exceeds one request per delay (generic cell rate algorithm).
+		Clock::time_point nextStart;
+
+		Clock::time_point blockedUntil;
+		Clock::duration backoff = Clock::duration(0);
+	};
+
+	std::map<std::string, HostState> hosts;
+	std::mutex mutex;
+
+	HostState& GetState(const std::string& url);// Caller must hold mutex
+	Clock::time_point GetEarliestStart(const HostState& state) const;// Caller must hold mutex
+	void Reserve(HostState& state, const Clock::time_point& start) const;// Caller must hold mutex
+};
+
+#endif// HOST_RATE_LIMITER_H_
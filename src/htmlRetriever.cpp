@@ -5,59 +5,80 @@
 
 // Local headers
 #include "htmlRetriever.h"
+#include "instrumentation.h"
 
 // Standard C++ headers
 #include <iostream>
 #include <cassert>
-
-//#define SAVE_TEST_FILE
-//#define LOAD_TEST_FILE
-#if defined(SAVE_TEST_FILE) || defined(LOAD_TEST_FILE)
-#include <fstream>
-const std::string testFileName("test.html");
-#endif
+#include <thread>
+#include <cctype>
+#include <ctime>
+#include <deque>
 
 const bool HTMLRetriever::verbose(false);
 const std::string HTMLRetriever::cookieFile("cookies");
+const unsigned int HTMLRetriever::maxAttempts(4);
 
-HTMLRetriever::HTMLRetriever(const std::string& userAgent, const std::chrono::steady_clock::duration& crawlDelay) : userAgent(userAgent), rateLimiter(crawlDelay)
+HTMLRetriever::HTMLRetriever(const std::string& userAgent, const std::chrono::steady_clock::duration& crawlDelay) : userAgent(userAgent), rateLimiter(std::make_shared<HostRateLimiter>(crawlDelay))
 {
 	DoGeneralCurlConfiguration();
 }
 
 HTMLRetriever::~HTMLRetriever()
 {
-	if (headerList)
-		curl_slist_free_all(headerList);
+	for (auto& handle : handlePool)
+		curl_easy_cleanup(handle);
+
+	if (multiHandle)
+		curl_multi_cleanup(multiHandle);
+
+	if (shareHandle)
+		curl_share_cleanup(shareHandle);
 
 	if (curl)
 		curl_easy_cleanup(curl);
+
+	if (headerList)
+		curl_slist_free_all(headerList);
 }
 	
 bool HTMLRetriever::GetHTML(const std::string& url, std::string& html)
 {
-#ifdef SAVE_TEST_FILE
-	bool ok(DoCURLGet(url, html));
-	if (!ok)
-		return false;
-	std::ofstream f(testFileName);
-	if (!f.good())
-		return false;
-	f << html;
-	return true;
-#elif defined(LOAD_TEST_FILE)
-	std::ifstream f(testFileName, std::ios::ate);
-	if (!f.good())
+	lastResponseCode = 0;
+	if (!IsAllowedByRobots(url))
+	{
+		std::cerr << "robots.txt does not allow us to get " << url << '\n';
 		return false;
+	}
+	
+	HTTPCache::Entry cachedEntry;
+	const bool haveCachedEntry(cache && cache->Load(url, cachedEntry));
+	if (haveCachedEntry && cache->IsFresh(cachedEntry))
+	{
+		Instrumentation::Count("http cache hits");
+		html = std::move(cachedEntry.body);
+		lastResponseCode = 200;
+		return true;
+	}
+	
+	return DoCURLGet(url, html, haveCachedEntry ? &cachedEntry : nullptr);
+}
 
-	html.reserve(f.tellg());
-	f.seekg(0, std::ios::beg);
-
-	html.assign((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
-	return true;
-#else
-	return DoCURLGet(url, html);
-#endif// LOAD_TEST_FILE
+// Looks up the host's rules the first time we see it, which also sets the host's crawl delay
+bool HTMLRetriever::IsAllowedByRobots(const std::string& url)
+{
+	if (!robotsCache || RobotsCache::IsRobotsTxtURL(url))
+		return true;
+		
+	const std::string host(HostRateLimiter::GetHost(url));
+	auto it(robotsRules.find(host));
+	if (it == robotsRules.end())
+	{
+		it = robotsRules.emplace(host, robotsCache->GetRules(*this, url)).first;
+		rateLimiter->SetDelay(url, it->second->GetCrawlDelay());
+	}
+	
+	return it->second->IsAllowed(url);
 }
 
 bool HTMLRetriever::DoGeneralCurlConfiguration()
@@ -71,59 +92,600 @@ bool HTMLRetriever::DoGeneralCurlConfiguration()
 		return false;
 	}
 
-	if (verbose)
-		CURLCallHasError(curl_easy_setopt(curl, CURLOPT_VERBOSE, 1L), "Failed to set verbose output");// Don't fail for this one
+	if (!headerList)
+	{
+		headerList = curl_slist_append(headerList, "Connection: Keep-Alive");
+		if (!headerList)
+		{
+			std::cerr << "Failed to append keep alive to header\n";
+			return false;
+		}
+	}
 
-	/*if (!caCertificatePath.empty())
-		curl_easy_setopt(curl, CURLOPT_CAPATH, caCertificatePath.c_str());*/
+	return ConfigureHandle(curl);
+}
 
-	if (CURLCallHasError(curl_easy_setopt(curl, CURLOPT_USE_SSL, CURLUSESSL_ALL), "Failed to enable SSL"))
+bool HTMLRetriever::ConfigureHandle(CURL* handle)
+{
+	if (verbose)
+		CURLCallHasError(curl_easy_setopt(handle, CURLOPT_VERBOSE, 1L), "Failed to set verbose output");// Don't fail for this one
+
+	if (!caCertificateFile.empty() &&
+		CURLCallHasError(curl_easy_setopt(handle, CURLOPT_CAINFO, caCertificateFile.c_str()), "Failed to set CA certificate file"))
 		return false;
 
-	if (CURLCallHasError(curl_easy_setopt(curl, CURLOPT_USERAGENT, userAgent.c_str()), "Failed to set user agent"))
+	if (CURLCallHasError(curl_easy_setopt(handle, CURLOPT_USE_SSL, CURLUSESSL_ALL), "Failed to enable SSL"))
 		return false;
 
-	if (CURLCallHasError(curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L), "Failed to enable location following"))
+	// Checklist pages compress very well.  An empty string offers every encoding this libcurl can decode (gzip, brotli, etc.).
+	if (CURLCallHasError(curl_easy_setopt(handle, CURLOPT_ACCEPT_ENCODING, ""), "Failed to enable compression"))
 		return false;
 
-	headerList = curl_slist_append(headerList, "Connection: Keep-Alive");
-	if (!headerList)
+	// HTTP/2 if the server agrees to it during the TLS handshake, otherwise HTTP/1.1.  Not fatal if libcurl
+	// was built without HTTP/2 support - we just stay with HTTP/1.1.
+	if (curl_easy_setopt(handle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS) == CURLE_OK)
 	{
-		std::cerr << "Failed to append keep alive to header\n";
-		return false;
+		// Wait for a connection that's being set up rather than opening another, so transfers to a host share one connection
+		CURLCallHasError(curl_easy_setopt(handle, CURLOPT_PIPEWAIT, 1L), "Failed to enable waiting for multiplexing");
 	}
 
-	if (CURLCallHasError(curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headerList), "Failed to set header"))
+	if (CURLCallHasError(curl_easy_setopt(handle, CURLOPT_USERAGENT, userAgent.c_str()), "Failed to set user agent"))
+		return false;
+
+	if (CURLCallHasError(curl_easy_setopt(handle, CURLOPT_FOLLOWLOCATION, 1L), "Failed to enable location following"))
+		return false;
+
+	if (CURLCallHasError(curl_easy_setopt(handle, CURLOPT_HTTPHEADER, headerList), "Failed to set header"))
 		return false;
 
 	// eBird requires cookies for following redirects, which are used for checklists
-	if (CURLCallHasError(curl_easy_setopt(curl, CURLOPT_COOKIEFILE, cookieFile.c_str()), "Failed to load the cookie file"))
+	if (CURLCallHasError(curl_easy_setopt(handle, CURLOPT_COOKIEFILE, cookieFile.c_str()), "Failed to load the cookie file"))
 		return false;
 
-	if (CURLCallHasError(curl_easy_setopt(curl, CURLOPT_COOKIEJAR, cookieFile.c_str()), "Failed to enable saving cookies"))
+	if (CURLCallHasError(curl_easy_setopt(handle, CURLOPT_COOKIEJAR, cookieFile.c_str()), "Failed to enable saving cookies"))
 		return false;
 
-	if (CURLCallHasError(curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, HTMLRetriever::CURLWriteCallback), "Failed to set the write callback"))
+	if (CURLCallHasError(curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, HTMLRetriever::CURLWriteCallback), "Failed to set the write callback"))
 		return false;
 
 	return true;
 }
 
-bool HTMLRetriever::DoCURLGet(const std::string& url, std::string& response)
+void HTMLRetriever::SetCACertificateFile(const std::string& fileName)
+{
+	caCertificateFile = fileName;
+	if (curl)
+		CURLCallHasError(curl_easy_setopt(curl, CURLOPT_CAINFO, caCertificateFile.c_str()), "Failed to set CA certificate file");
+	for (auto& handle : handlePool)
+		CURLCallHasError(curl_easy_setopt(handle, CURLOPT_CAINFO, caCertificateFile.c_str()), "Failed to set CA certificate file");
+}
+
+bool HTMLRetriever::DoCURLGet(const std::string& url, std::string& response, HTTPCache::Entry* cachedEntry)
 {
 	assert(curl);
+	for (unsigned int attempt = 1; ; ++attempt)
+	{
+		Instrumentation::Span waitSpan("rate limit wait");
+		rateLimiter->Wait(url);
+		waitSpan.End();
 
-	if (CURLCallHasError(curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response), "Failed to set write data"))
+		lastResponseCode = 0;
+		ResponseHeaders responseHeaders;
+		struct curl_slist* requestHeaders(nullptr);
+		if (!PrepareRequest(curl, url, response, responseHeaders, cachedEntry, requestHeaders))
+		{
+			RestoreHeaders(curl, requestHeaders);
+			return false;
+		}
+
+		if (CURLCallHasError(curl_easy_setopt(curl, CURLOPT_POST, 0L), "Failed to set action to GET") ||
+			CURLCallHasError(curl_easy_perform(curl), "Failed issuing https GET"))
+		{
+			RestoreHeaders(curl, requestHeaders);
+			return false;
+		}
+		
+		RecordStatistics(curl, url, responseHeaders, response.length());
+		curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &lastResponseCode);
+		
+		if (!CheckForBackoff(curl, url, responseHeaders))
+		{
+			const bool succeeded(CompleteRequest(curl, url, response, responseHeaders, cachedEntry, requestHeaders));
+			if (succeeded && lastResponseCode == 304)
+				lastResponseCode = 200;// We have the cached page
+			return succeeded;
+		}
+			
+		RestoreHeaders(curl, requestHeaders);
+		if (attempt == maxAttempts)
+		{
+			std::cerr << "Server is still asking us to slow down after " << maxAttempts << " attempts to get " << url << '\n';
+			return false;
+		}
+	}
+}
+
+bool HTMLRetriever::PrepareRequest(CURL* handle, const std::string& url, std::string& response, ResponseHeaders& responseHeaders,
+	const HTTPCache::Entry* cachedEntry, struct curl_slist*& requestHeaders, Stream* stream)
+{
+	response.clear();
+	if (stream)
+	{
+		stream->response = &response;
+		stream->url = &url;
+		stream->responseHeaders = &responseHeaders;
+		stream->cacheWriter.reset();
+		stream->streamed = false;
+		stream->streamedBytes = 0;
+	}
+	
+	// Pooled handles may be used with or without streaming, so the write function is set for every request
+	if (CURLCallHasError(curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, stream ? HTMLRetriever::CURLStreamCallback : HTMLRetriever::CURLWriteCallback), "Failed to set the write callback") ||
+		CURLCallHasError(curl_easy_setopt(handle, CURLOPT_WRITEDATA, stream ? static_cast<void*>(stream) : static_cast<void*>(&response)), "Failed to set write data") ||
+		CURLCallHasError(curl_easy_setopt(handle, CURLOPT_HEADERFUNCTION, HTMLRetriever::CURLHeaderCallback), "Failed to set the header callback") ||
+		CURLCallHasError(curl_easy_setopt(handle, CURLOPT_HEADERDATA, &responseHeaders), "Failed to set header data") ||
+		CURLCallHasError(curl_easy_setopt(handle, CURLOPT_URL, url.c_str()), "Failed to set URL"))
+		return false;
+		
+	if (!cachedEntry || !cache || !cache->HasValidators(*cachedEntry))
+		return true;
+		
+	// Revalidate the cached copy so unchanged pages cost only a 304 response
+	for (const curl_slist* h = headerList; h; h = h->next)
+		requestHeaders = curl_slist_append(requestHeaders, h->data);
+	if (!cachedEntry->eTag.empty())
+		requestHeaders = curl_slist_append(requestHeaders, ("If-None-Match: " + cachedEntry->eTag).c_str());
+	if (!cachedEntry->lastModified.empty())
+		requestHeaders = curl_slist_append(requestHeaders, ("If-Modified-Since: " + cachedEntry->lastModified).c_str());
+		
+	if (!requestHeaders)
+	{
+		std::cerr << "Failed to build conditional request header\n";
 		return false;
+	}
+	
+	return !CURLCallHasError(curl_easy_setopt(handle, CURLOPT_HTTPHEADER, requestHeaders), "Failed to set header");
+}
 
-	if (CURLCallHasError(curl_easy_setopt(curl, CURLOPT_POST, 0L), "Failed to set action to GET"))
+bool HTMLRetriever::CompleteRequest(CURL* handle, const std::string& url, std::string& response, const ResponseHeaders& responseHeaders,
+	HTTPCache::Entry* cachedEntry, struct curl_slist*& requestHeaders, Stream* stream)
+{
+	RestoreHeaders(handle, requestHeaders);
+	long responseCode(0);
+	if (CURLCallHasError(curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &responseCode), "Failed to get response code"))
 		return false;
+		
+	// Backoff responses (429 and 503) have already been dealt with, so anything else that isn't the page is a failure.
+	// Error bodies must not be taken for the page (or cached).
+	if (responseCode == 304 && (!cachedEntry || !cache))
+	{
+		std::cerr << "Server responded with 304 but we have no cached copy of " << url << '\n';
+		return false;
+	}
+	else if (responseCode != 304 && (responseCode < 200 || responseCode >= 300))
+	{
+		std::cerr << "Server responded with " << responseCode << " to request for " << url << '\n';
+		return false;
+	}
+	
+	if (!cache)
+		return true;
+		
+	if (stream && stream->streamed)
+	{
+		if (stream->cacheWriter)
+			cache->Commit(*stream->cacheWriter);
+		stream->cacheWriter.reset();
+		return true;
+	}
+		
+	const auto& eTag(responseHeaders.eTag.empty() && cachedEntry ? cachedEntry->eTag : responseHeaders.eTag);
+	const auto& lastModified(responseHeaders.lastModified.empty() && cachedEntry ? cachedEntry->lastModified : responseHeaders.lastModified);
+	if (responseCode == 304 && cachedEntry)
+	{
+		Instrumentation::Count("http cache revalidations");
+		cache->Store(url, cachedEntry->body, eTag, lastModified);
+		response = std::move(cachedEntry->body);
+	}
+	else if (responseCode == 200)
+		cache->Store(url, response, responseHeaders.eTag, responseHeaders.lastModified);
+		
+	return true;
+}
 
-	if (CURLCallHasError(curl_easy_setopt(curl, CURLOPT_URL, url.c_str()), "Failed to set URL"))
+// Reports the response to the rate limiter.  Returns true if the server asked us to slow down, in which case the
+// response doesn't contain the page and the request should be tried again.
+bool HTMLRetriever::CheckForBackoff(CURL* handle, const std::string& url, const ResponseHeaders& responseHeaders)
+{
+	long responseCode(0);
+	if (CURLCallHasError(curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &responseCode), "Failed to get response code"))
 		return false;
+		
+	rateLimiter->ReportResponse(url, responseCode, ParseRetryAfter(responseHeaders.retryAfter));
+	return HostRateLimiter::IsBackoffResponse(responseCode);
+}
+
+void HTMLRetriever::RecordStatistics(CURL* handle, const std::string& url, const ResponseHeaders& responseHeaders, const std::uint64_t& decodedBytes)
+{
+	TransferStatistics transfer;
+	transfer.url = url;
+	transfer.contentEncoding = responseHeaders.contentEncoding;
+	transfer.decodedBytes = decodedBytes;
+	
+	// These can't fail for a handle that has completed a transfer, so results aren't checked
+	long httpVersion(0), headerSize(0), connectCount(0);
+	curl_off_t bodySize(0), nameLookupTime(0), connectTime(0), appConnectTime(0), startTransferTime(0), totalTime(0);
+	curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &transfer.responseCode);
+	curl_easy_getinfo(handle, CURLINFO_HTTP_VERSION, &httpVersion);
+	curl_easy_getinfo(handle, CURLINFO_NUM_CONNECTS, &connectCount);
+	curl_easy_getinfo(handle, CURLINFO_HEADER_SIZE, &headerSize);
+	curl_easy_getinfo(handle, CURLINFO_SIZE_DOWNLOAD_T, &bodySize);
+	curl_easy_getinfo(handle, CURLINFO_NAMELOOKUP_TIME_T, &nameLookupTime);
+	curl_easy_getinfo(handle, CURLINFO_CONNECT_TIME_T, &connectTime);
+	curl_easy_getinfo(handle, CURLINFO_APPCONNECT_TIME_T, &appConnectTime);
+	curl_easy_getinfo(handle, CURLINFO_STARTTRANSFER_TIME_T, &startTransferTime);
+	curl_easy_getinfo(handle, CURLINFO_TOTAL_TIME_T, &totalTime);
+	
+	if (httpVersion == CURL_HTTP_VERSION_2_0)
+		transfer.protocol = "HTTP/2";
+	else if (httpVersion == CURL_HTTP_VERSION_1_1)
+		transfer.protocol = "HTTP/1.1";
+	else if (httpVersion == CURL_HTTP_VERSION_1_0)
+		transfer.protocol = "HTTP/1.0";
+	else if (httpVersion != 0)
+		transfer.protocol = "HTTP/" + std::to_string(httpVersion);
+		
+	transfer.newConnection = connectCount > 0;
+	transfer.headerBytes = static_cast<std::uint64_t>(headerSize);
+	transfer.bodyBytes = static_cast<std::uint64_t>(bodySize);
+	
+	// Times are in microseconds from the start of the transfer
+	connectTime = std::max(connectTime, appConnectTime);
+	transfer.nameLookupTime = nameLookupTime * 1.0e-6;
+	transfer.connectTime = connectTime * 1.0e-6;
+	transfer.timeToFirstByte = startTransferTime * 1.0e-6;
+	transfer.totalTime = totalTime * 1.0e-6;
+	statistics.push_back(transfer);
+	
+	if (!Instrumentation::IsEnabled())
+		return;
+		
+	Instrumentation::Count("requests");
+	Instrumentation::Count("bytes received", transfer.headerBytes + transfer.bodyBytes);
+	Instrumentation::Count("bytes decoded", transfer.decodedBytes);
+	if (transfer.newConnection)
+		Instrumentation::Count("new connections");
+		
+	// We're called as the transfer completes, so work back from now.  Concurrent transfers overlap, so each
+	// pool slot gets its own track.
+	const auto end(Instrumentation::Clock::now());
+	const auto start(end - std::chrono::microseconds(totalTime));
+	const auto slot(std::find(handlePool.begin(), handlePool.end(), handle));
+	const std::string track(slot == handlePool.end() ? "transfer" : "transfer " + std::to_string(slot - handlePool.begin() + 1));
+	Instrumentation::AddSpan("transfer", start, end, track);
+	if (transfer.newConnection)
+	{
+		Instrumentation::AddSpan("dns lookup", start, start + std::chrono::microseconds(nameLookupTime), track);
+		Instrumentation::AddSpan("connect", start + std::chrono::microseconds(nameLookupTime), start + std::chrono::microseconds(connectTime), track);
+	}
+	Instrumentation::AddSpan("wait for response", start + std::chrono::microseconds(connectTime), start + std::chrono::microseconds(startTransferTime), track);
+	Instrumentation::AddSpan("download", start + std::chrono::microseconds(startTransferTime), end, track);
+}
 
-	if (CURLCallHasError(curl_easy_perform(curl), "Failed issuing https GET"))
+// Value is either a number of seconds or an HTTP date
+HostRateLimiter::Clock::duration HTMLRetriever::ParseRetryAfter(const std::string& value)
+{
+	if (value.empty())
+		return HostRateLimiter::Clock::duration(0);
+		
+	if (std::all_of(value.begin(), value.end(), [](const unsigned char& c) { return std::isdigit(c) != 0; }))
+		return std::chrono::seconds(std::stoll(value.substr(0, 9)));// Anything longer is far past the limiter's maximum anyway
+		
+	const std::time_t retryTime(curl_getdate(value.c_str(), nullptr));
+	const std::time_t now(std::time(nullptr));
+	if (retryTime == -1 || retryTime <= now)
+		return HostRateLimiter::Clock::duration(0);
+	return std::chrono::seconds(retryTime - now);
+}
+
+void HTMLRetriever::RestoreHeaders(CURL* handle, struct curl_slist*& requestHeaders)
+{
+	if (!requestHeaders)
+		return;
+		
+	CURLCallHasError(curl_easy_setopt(handle, CURLOPT_HTTPHEADER, headerList), "Failed to reset header");
+	curl_slist_free_all(requestHeaders);
+	requestHeaders = nullptr;
+}
+
+bool HTMLRetriever::GetHTML(const std::vector<std::string>& urls, std::vector<std::string>& html)
+{
+	html.clear();
+	html.resize(urls.size());
+	bool allSucceeded(true);
+	auto handler([&html, &allSucceeded](const std::vector<std::string>::size_type& index, const bool& success, std::string& response)
+	{
+		if (success)
+			html[index] = std::move(response);
+		else
+			allSucceeded = false;
+		return true;
+	});
+	
+	return GetHTML(urls, handler) && allSucceeded;
+}
+
+bool HTMLRetriever::GetHTML(const std::vector<std::string>& urls, const ResponseHandler& handler, const ChunkHandler& chunkHandler)
+{
+	if (!InitializeHandlePool())
 		return false;
+		
+	struct Transfer
+	{
+		CURL* handle;
+		std::vector<std::string>::size_type index;
+		std::string response;
+		ResponseHeaders responseHeaders;
+		HTTPCache::Entry cachedEntry;
+		bool haveCachedEntry;
+		struct curl_slist* requestHeaders = nullptr;
+		Stream stream;
+	};
+	
+	std::vector<Transfer> transfers(handlePool.size());
+	std::vector<Transfer*> idleTransfers;
+	for (unsigned int i = 0; i < transfers.size(); ++i)
+	{
+		transfers[i].handle = handlePool[i];
+		transfers[i].stream.handle = handlePool[i];
+		transfers[i].stream.chunkHandler = &chunkHandler;
+		transfers[i].stream.cache = cache.get();
+		idleTransfers.push_back(&transfers[i]);
+	}
+	
+	std::vector<std::string>::size_type nextURL(0);
+	std::deque<std::vector<std::string>::size_type> retryQueue;// Requests the server asked us to slow down for; these go first
+	std::vector<unsigned int> attempts(urls.size(), 0);
+	int runningCount(0);
+	bool ok(true);
+	auto haveRequestsToStart([&nextURL, &urls, &retryQueue]()
+	{
+		return nextURL < urls.size() || !retryQueue.empty();
+	});
+	
+	// Cache lookup for the next request, held until the rate limiter lets us start it
+	bool nextURLChecked(false);
+	std::vector<std::string>::size_type checkedIndex(0);
+	bool nextURLCached(false);
+	HTTPCache::Entry nextCachedEntry;
+	
+	// Only tracked while instrumentation is enabled
+	bool waitingForRateLimiter(false);
+	HostRateLimiter::Clock::time_point rateLimitWaitStart;
+	
+	while (ok && (haveRequestsToStart() || runningCount > 0))
+	{
+		// Start as many transfers as the crawl delay and the pool size allow.  We never sleep here; instead we
+		// cap the wait below so we come back around when the next start is permitted.
+		HostRateLimiter::Clock::duration timeToNextStart(std::chrono::seconds(1));
+		while (haveRequestsToStart() && !idleTransfers.empty())
+		{
+			const bool isRetry(!retryQueue.empty());
+			const auto index(isRetry ? retryQueue.front() : nextURL);
+			auto markStarted([isRetry, &retryQueue, &nextURL]()
+			{
+				if (isRetry)
+					retryQueue.pop_front();
+				else
+					++nextURL;
+			});
+			
+			if (!nextURLChecked || checkedIndex != index)// A retry may have been queued ahead of the request we checked
+			{
+				if (!IsAllowedByRobots(urls[index]))
+				{
+					std::cerr << "robots.txt does not allow us to get " << urls[index] << '\n';
+					Instrumentation::Count("robots.txt disallowed");
+					markStarted();
+					std::string empty;
+					if (!handler(index, false, empty))
+					{
+						ok = false;
+						break;
+					}
+					continue;
+				}
+				
+				nextURLChecked = true;
+				checkedIndex = index;
+				nextURLCached = cache && cache->Load(urls[index], nextCachedEntry);
+				if (nextURLCached && cache->IsFresh(nextCachedEntry))
+				{
+					// Fresh cache hits don't count against the crawl delay
+					Instrumentation::Count("http cache hits");
+					nextURLChecked = false;
+					markStarted();
+					if (!handler(index, true, nextCachedEntry.body))
+					{
+						ok = false;
+						break;
+					}
+					continue;
+				}
+			}
+			
+			if (!rateLimiter->TryEnter(urls[index], timeToNextStart))
+			{
+				if (!waitingForRateLimiter && Instrumentation::IsEnabled())
+				{
+					waitingForRateLimiter = true;
+					rateLimitWaitStart = HostRateLimiter::Clock::now();
+				}
+				break;
+			}
+			
+			if (waitingForRateLimiter)
+			{
+				Instrumentation::AddSpan("rate limit wait", rateLimitWaitStart, HostRateLimiter::Clock::now(), "rate limiter");
+				waitingForRateLimiter = false;
+			}
+				
+			Transfer* t(idleTransfers.back());
+			idleTransfers.pop_back();
+			t->index = index;
+			t->stream.index = index;
+			t->haveCachedEntry = nextURLCached;
+			t->cachedEntry = std::move(nextCachedEntry);
+			t->responseHeaders = ResponseHeaders();
+			nextURLChecked = false;
+			
+			if (!PrepareRequest(t->handle, urls[index], t->response, t->responseHeaders, t->haveCachedEntry ? &t->cachedEntry : nullptr,
+					t->requestHeaders, chunkHandler ? &t->stream : nullptr) ||
+				CURLCallHasError(curl_easy_setopt(t->handle, CURLOPT_PRIVATE, t), "Failed to set transfer data") ||
+				CURLMCallHasError(curl_multi_add_handle(multiHandle, t->handle), "Failed to add transfer"))
+			{
+				ok = false;
+				break;
+			}
+			
+			markStarted();
+			++attempts[index];
+			++runningCount;
+		}
+		
+		if (!ok)
+			break;
+		else if (runningCount == 0)
+		{
+			if (haveRequestsToStart())
+				std::this_thread::sleep_for(timeToNextStart);
+			continue;
+		}
+		
+		if (CURLMCallHasError(curl_multi_perform(multiHandle, &runningCount), "Failed to perform transfers"))
+		{
+			ok = false;
+			break;
+		}
+		
+		CURLMsg* message;
+		int messagesInQueue;
+		while ((message = curl_multi_info_read(multiHandle, &messagesInQueue)))
+		{
+			if (message->msg != CURLMSG_DONE)
+				continue;
+				
+			Transfer* t;
+			curl_easy_getinfo(message->easy_handle, CURLINFO_PRIVATE, &t);
+			curl_multi_remove_handle(multiHandle, t->handle);
+			bool success(!CURLCallHasError(message->data.result, "Failed issuing https GET"));
+			RecordStatistics(t->handle, urls[t->index], t->responseHeaders, t->response.length() + (chunkHandler ? t->stream.streamedBytes : 0));
+			bool retry(false);
+			if (success && CheckForBackoff(t->handle, urls[t->index], t->responseHeaders))
+			{
+				retry = attempts[t->index] < maxAttempts;
+				if (!retry)
+					std::cerr << "Server is still asking us to slow down after " << maxAttempts << " attempts to get " << urls[t->index] << '\n';
+				success = false;
+			}
+			
+			if (success)
+				success = CompleteRequest(t->handle, urls[t->index], t->response, t->responseHeaders, t->haveCachedEntry ? &t->cachedEntry : nullptr,
+					t->requestHeaders, chunkHandler ? &t->stream : nullptr);
+			else
+				RestoreHeaders(t->handle, t->requestHeaders);
+			t->stream.cacheWriter.reset();// Discards a partial body
+			idleTransfers.push_back(t);
+			
+			if (retry)
+			{
+				retryQueue.push_back(t->index);
+				continue;
+			}
+			
+			if (!handler(t->index, success, t->response))
+			{
+				ok = false;
+				break;
+			}
+		}
+		
+		if (!ok)
+			break;
+		
+		// Returns early if there is socket activity
+		const bool waitingToStart(haveRequestsToStart() && !idleTransfers.empty());
+		const auto waitTime(std::max(std::chrono::duration_cast<std::chrono::milliseconds>(timeToNextStart), std::chrono::milliseconds(1)));
+		if (CURLMCallHasError(curl_multi_wait(multiHandle, nullptr, 0, waitingToStart ? static_cast<int>(waitTime.count()) : 1000, nullptr), "Failed to wait for transfers"))
+			ok = false;
+	}
+	
+	// Leave the pool ready for the next call even if we're bailing out early
+	for (auto& t : transfers)
+	{
+		curl_multi_remove_handle(multiHandle, t.handle);
+		RestoreHeaders(t.handle, t.requestHeaders);
+	}
+	
+	return ok;
+}
+
+bool HTMLRetriever::InitializeHandlePool()
+{
+	if (!multiHandle)
+	{
+		multiHandle = curl_multi_init();
+		if (!multiHandle)
+		{
+			std::cerr << "Failed to initialize CURL multi handle\n";
+			return false;
+		}
+	}
+	
+	if (!shareHandle)
+	{
+		shareHandle = curl_share_init();
+		if (!shareHandle)
+		{
+			std::cerr << "Failed to initialize CURL share handle\n";
+			return false;
+		}
+		
+		// All transfers run on one thread, so no lock functions are needed
+		curl_share_setopt(shareHandle, CURLSHOPT_SHARE, CURL_LOCK_DATA_COOKIE);
+		curl_share_setopt(shareHandle, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+		curl_share_setopt(shareHandle, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+	}
+	
+	if (curl_multi_setopt(multiHandle, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX) != CURLM_OK)
+		std::cerr << "Failed to enable multiplexing\n";// Not fatal - we'll use separate connections
+		
+	if (curl_multi_setopt(multiHandle, CURLMOPT_MAX_HOST_CONNECTIONS, static_cast<long>(maxConcurrentTransfers)) != CURLM_OK)
+		std::cerr << "Failed to limit connections per host\n";// Not fatal - the pool size limits us, too
+		
+	while (handlePool.size() < maxConcurrentTransfers)
+	{
+		CURL* handle(curl_easy_init());
+		if (!handle)
+		{
+			std::cerr << "Failed to initialize CURL" << std::endl;
+			return false;
+		}
+		
+		handlePool.push_back(handle);
+		if (!ConfigureHandle(handle) ||
+			CURLCallHasError(curl_easy_setopt(handle, CURLOPT_SHARE, shareHandle), "Failed to set share handle") ||
+			CURLCallHasError(curl_easy_setopt(handle, CURLOPT_POST, 0L), "Failed to set action to GET"))
+			return false;
+	}
+	
+	// Only keep as many handles as we've been asked to use
+	while (handlePool.size() > maxConcurrentTransfers)
+	{
+		curl_easy_cleanup(handlePool.back());
+		handlePool.pop_back();
+	}
+	
 	return true;
 }
 
@@ -136,6 +698,77 @@ size_t HTMLRetriever::CURLWriteCallback(char *ptr, size_t size, size_t nmemb, vo
 	return totalSize;
 }
 
+size_t HTMLRetriever::CURLStreamCallback(char *ptr, size_t size, size_t nmemb, void *userData)
+{
+	const size_t totalSize(size * nmemb);
+	Stream& stream(*static_cast<Stream*>(userData));
+	
+	long responseCode(0);
+	curl_easy_getinfo(stream.handle, CURLINFO_RESPONSE_CODE, &responseCode);
+	if (responseCode != 200)
+	{
+		stream.response->append(ptr, totalSize);
+		return totalSize;
+	}
+	
+	if (!stream.streamed)
+	{
+		stream.streamed = true;
+		if (stream.cache)
+			stream.cacheWriter = stream.cache->BeginStore(*stream.url, stream.responseHeaders->eTag, stream.responseHeaders->lastModified);
+	}
+	
+	const std::string_view data(ptr, totalSize);
+	stream.streamedBytes += totalSize;
+	if (stream.cacheWriter && !stream.cacheWriter->Append(data))
+		stream.cacheWriter.reset();// Not an error - the page just won't be cached
+		
+	if (!(*stream.chunkHandler)(stream.index, data))
+		return 0;// Fails the transfer
+	return totalSize;
+}
+
+size_t HTMLRetriever::CURLHeaderCallback(char *buffer, size_t size, size_t nitems, void *userData)
+{
+	const size_t totalSize(size * nitems);
+	ResponseHeaders& headers(*static_cast<ResponseHeaders*>(userData));
+	const std::string line(buffer, totalSize);
+	
+	// Start over for each response when following redirects
+	if (line.compare(0, 5, "HTTP/") == 0)
+	{
+		headers = ResponseHeaders();
+		return totalSize;
+	}
+	
+	const auto colon(line.find(':'));
+	if (colon == std::string::npos)
+		return totalSize;
+		
+	std::string name(line.substr(0, colon));
+	std::transform(name.begin(), name.end(), name.begin(), [](const unsigned char& c)
+	{
+		return static_cast<char>(std::tolower(c));
+	});
+	
+	const auto valueStart(line.find_first_not_of(" \t", colon + 1));
+	const auto valueEnd(line.find_last_not_of(" \t\r\n"));
+	if (valueStart == std::string::npos || valueEnd < valueStart)
+		return totalSize;
+	const std::string value(line.substr(valueStart, valueEnd - valueStart + 1));
+	
+	if (name == "etag")
+		headers.eTag = value;
+	else if (name == "last-modified")
+		headers.lastModified = value;
+	else if (name == "retry-after")
+		headers.retryAfter = value;
+	else if (name == "content-encoding")
+		headers.contentEncoding = value;
+		
+	return totalSize;
+}
+
 bool HTMLRetriever::CURLCallHasError(const CURLcode& result, const std::string& message)
 {
 	if (result == CURLE_OK)
@@ -144,3 +777,12 @@ bool HTMLRetriever::CURLCallHasError(const CURLcode& result, const std::string&
 	std::cerr << message << ":  " << curl_easy_strerror(result) << '\n';
 	return true;
 }
+
+bool HTMLRetriever::CURLMCallHasError(const CURLMcode& result, const std::string& message)
+{
+	if (result == CURLM_OK)
+		return false;
+
+	std::cerr << message << ":  " << curl_multi_strerror(result) << '\n';
+	return true;
+}
@@ -7,38 +7,134 @@
 #define HTML_RETRIEVER_H_
 
 // Local headers
-#include "throttledSection.h"
+#include "hostRateLimiter.h"
+#include "httpCache.h"
+#include "robotsCache.h"
+#include "pageFetcher.h"
 
 // cURL headers
 #include <curl/curl.h>
 
 // Standard C++ headers
 #include <string>
+#include <string_view>
 #include <chrono>
+#include <algorithm>
+#include <vector>
+#include <functional>
+#include <memory>
+#include <map>
 
-class HTMLRetriever
+class HTMLRetriever : public PageFetcher
 {
 public:
 	HTMLRetriever(const std::string& userAgent, const std::chrono::steady_clock::duration& crawlDelay = std::chrono::steady_clock::duration(0));
 	~HTMLRetriever();
 	
-	bool GetHTML(const std::string& url, std::string& html);
-	void SetCrawlDelay(const std::chrono::steady_clock::duration& crawlDelay) { rateLimiter.SetMinAccessDelta(crawlDelay); }
+	bool GetHTML(const std::string& url, std::string& html) override;
+	
+	// HTTP status for the last single page request:  200 for pages from the cache (including revalidated copies),
+	// 0 if no response was received.  Lets callers tell why a request failed (i.e. 404 vs. 503).
+	long GetLastResponseCode() const { return lastResponseCode; }
+	
+	// Downloads several pages with overlapping transfers.  Request starts are still spaced by the crawl delay.
+	// With a chunk handler, bodies of successful responses from the server are streamed to it, but pages from the
+	// cache are still passed whole to the response handler.
+	bool GetHTML(const std::vector<std::string>& urls, const ResponseHandler& handler, const ChunkHandler& chunkHandler = ChunkHandler()) override;
+	bool GetHTML(const std::vector<std::string>& urls, std::vector<std::string>& html);// Returns false if any page failed
+	
+	void SetCrawlDelay(const std::chrono::steady_clock::duration& crawlDelay) { rateLimiter->SetDefaultDelay(crawlDelay); }
+	void SetCrawlDelay(const std::string& url, const std::chrono::steady_clock::duration& crawlDelay) { rateLimiter->SetDelay(url, crawlDelay); }// For the URL's host only
+	void SetMaxConcurrentTransfers(const unsigned int& maxTransfers) { maxConcurrentTransfers = std::max(maxTransfers, 1U); }
 	std::string GetUserAgent() const { return userAgent; }
+	
+	// Retrievers sharing a rate limiter are collectively held to its crawl delays
+	void SetRateLimiter(std::shared_ptr<HostRateLimiter> newRateLimiter) { rateLimiter = newRateLimiter; }
+	
+	// Responses are served from (and saved to) the cache when one is set
+	void SetCache(std::shared_ptr<HTTPCache> newCache) { cache = newCache; }
+	
+	// For servers with certificates not signed by a well-known authority (i.e. a local test server)
+	void SetCACertificateFile(const std::string& fileName);
+	
+	// One record for each request sent (including retries and revalidations, but not fresh cache hits)
+	const std::vector<TransferStatistics>& GetStatistics() const override { return statistics; }
+	void ClearStatistics() { statistics.clear(); }
+	
+	// When set, URLs disallowed by their host's robots.txt aren't requested, and each host's crawl delay is taken from it
+	void SetRobotsCache(std::shared_ptr<RobotsCache> newRobotsCache) { robotsCache = newRobotsCache; robotsRules.clear(); }
 
 protected:
 	const std::string userAgent;
+	std::string caCertificateFile;
 	static const bool verbose;
 	static const std::string cookieFile;
+	static const unsigned int maxAttempts;// Per URL, when the server responds with 429 or 503
+	
+	long lastResponseCode = 0;
 	
-	ThrottledSection rateLimiter;
+	std::shared_ptr<HostRateLimiter> rateLimiter;
 	
 	CURL* curl = nullptr;
 	struct curl_slist* headerList = nullptr;
 	bool DoGeneralCurlConfiguration();
-	bool DoCURLGet(const std::string& url, std::string& response);
+	bool ConfigureHandle(CURL* handle);
+	
+	unsigned int maxConcurrentTransfers = 4;
+	CURLM* multiHandle = nullptr;
+	CURLSH* shareHandle = nullptr;// Lets pooled handles share cookies and TLS sessions
+	std::vector<CURL*> handlePool;
+	bool InitializeHandlePool();
+	
+	std::shared_ptr<HTTPCache> cache;
+	
+	std::shared_ptr<RobotsCache> robotsCache;
+	std::map<std::string, std::shared_ptr<const RobotsRules>> robotsRules;// By host, for the life of this retriever
+	bool IsAllowedByRobots(const std::string& url);
+	
+	struct ResponseHeaders
+	{
+		std::string eTag;
+		std::string lastModified;
+		std::string retryAfter;
+		std::string contentEncoding;
+	};
+	
+	// Destination for a body that's passed along as it arrives
+	struct Stream
+	{
+		CURL* handle;
+		std::vector<std::string>::size_type index;
+		const ChunkHandler* chunkHandler;
+		std::string* response;// Other responses (i.e. errors) are collected as usual
+		
+		HTTPCache* cache;
+		const std::string* url;
+		const ResponseHeaders* responseHeaders;
+		std::unique_ptr<HTTPCache::Writer> cacheWriter;
+		
+		bool streamed;// True once the body is being passed along
+		std::uint64_t streamedBytes;
+	};
+	
+	bool PrepareRequest(CURL* handle, const std::string& url, std::string& response, ResponseHeaders& responseHeaders,
+		const HTTPCache::Entry* cachedEntry, struct curl_slist*& requestHeaders, Stream* stream = nullptr);
+	bool CompleteRequest(CURL* handle, const std::string& url, std::string& response, const ResponseHeaders& responseHeaders,
+		HTTPCache::Entry* cachedEntry, struct curl_slist*& requestHeaders, Stream* stream = nullptr);
+	void RestoreHeaders(CURL* handle, struct curl_slist*& requestHeaders);
+	bool CheckForBackoff(CURL* handle, const std::string& url, const ResponseHeaders& responseHeaders);
+	
+	static HostRateLimiter::Clock::duration ParseRetryAfter(const std::string& value);
+	
+	std::vector<TransferStatistics> statistics;
+	void RecordStatistics(CURL* handle, const std::string& url, const ResponseHeaders& responseHeaders, const std::uint64_t& decodedBytes);
+	
+	bool DoCURLGet(const std::string& url, std::string& response, HTTPCache::Entry* cachedEntry);
 	static size_t CURLWriteCallback(char *ptr, size_t size, size_t nmemb, void *userData);
+	static size_t CURLStreamCallback(char *ptr, size_t size, size_t nmemb, void *userData);
+	static size_t CURLHeaderCallback(char *buffer, size_t size, size_t nitems, void *userData);
 	static bool CURLCallHasError(const CURLcode& result, const std::string& message);
+	static bool CURLMCallHasError(const CURLMcode& result, const std::string& message);
 };
 
 #endif// HTML_RETRIEVER_H_
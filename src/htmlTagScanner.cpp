@@ -0,0 +1,207 @@
+// File:  htmlTagScanner.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Forward-only tokenizer that steps from tag to tag through an HTML buffer.
+//        Nothing is copied - tags and text are returned as views into the buffer.
+
+// Local headers
+#include "htmlTagScanner.h"
+
+// Standard C++ headers
+#include <cctype>
+#include <algorithm>
+
+// Regions which may contain text that looks like tags
+const PatternSearcher HTMLTagScanner::commentStart("<!--");
+const PatternSearcher HTMLTagScanner::scriptStart("<script");
+const PatternSearcher HTMLTagScanner::styleStart("<style");
+
+bool HTMLTagScanner::Next()
+{
+	size_type position(GetResumePosition());
+	while (position < html.length() && (position = html.find('<', position)) != std::string_view::npos)
+	{
+		if (html.compare(position, 4, "<!--") == 0)
+		{
+			position = html.find("-->", position + 4);
+			if (position == std::string_view::npos)
+				break;
+			position += 3;
+			continue;
+		}
+
+		size_type nameStart(position + 1);
+		const bool isEndTag(nameStart < html.length() && html[nameStart] == '/');
+		if (isEndTag)
+			++nameStart;
+
+		if (nameStart >= html.length())
+			break;
+		else if (html[nameStart] == '!' || html[nameStart] == '?')// Doctype or processing instruction
+		{
+			position = html.find('>', nameStart);
+			continue;
+		}
+		else if (!std::isalpha(static_cast<unsigned char>(html[nameStart])))// Stray '<' in text
+		{
+			++position;
+			continue;
+		}
+
+		size_type nameEnd(nameStart + 1);
+		while (nameEnd < html.length() && !std::isspace(static_cast<unsigned char>(html[nameEnd])) &&
+			html[nameEnd] != '>' && html[nameEnd] != '/')
+			++nameEnd;
+
+		const auto end(FindTagEnd(nameEnd));
+		if (end == std::string_view::npos)
+			break;
+
+		valid = true;
+		tagStart = position;
+		tagEnd = end;
+		endTag = isEndTag;
+		name = html.substr(nameStart, nameEnd - nameStart);
+		return true;
+	}
+
+	valid = false;
+	tagStart = html.length();
+	tagEnd = html.length();
+	endTag = false;
+	name = std::string_view();
+	return false;
+}
+
+// Moves to the first tag at or after the specified position
+bool HTMLTagScanner::Seek(const size_type& position)
+{
+	valid = false;
+	tagEnd = position;
+	return Next();
+}
+
+// Returns the position from which to search for the next tag
+HTMLTagScanner::size_type HTMLTagScanner::GetResumePosition()
+{
+	// Contents of script and style elements may contain '<' which doesn't start a tag
+	if (valid && !endTag && (NamesMatch(name, "script") || NamesMatch(name, "style")))
+		SkipRawText();
+	return tagEnd;
+}
+
+HTMLTagScanner::size_type HTMLTagScanner::FindTagEnd(size_type position) const
+{
+	// Quoted attribute values may contain '>'
+	for (; position < html.length(); ++position)
+	{
+		const char c(html[position]);
+		if (c == '>')
+			return position + 1;
+		else if ((c == '"' || c == '\'') && html[position - 1] == '=')// Otherwise it's not the start of a value (i.e. an apostrophe in an unquoted value)
+		{
+			position = html.find(c, position + 1);
+			if (position == std::string_view::npos)
+				return std::string_view::npos;
+		}
+	}
+
+	return std::string_view::npos;
+}
+
+void HTMLTagScanner::SkipRawText()
+{
+	size_type position(tagEnd);
+	while ((position = html.find("</", position)) != std::string_view::npos)
+	{
+		if (NamesMatch(html.substr(position + 2, name.length()), name))
+		{
+			tagEnd = position;
+			return;
+		}
+
+		position += 2;
+	}
+
+	tagEnd = html.length();
+}
+
+bool HTMLTagScanner::SkipTo(const PatternSearcher& prefix, const PatternSearcher& stopPrefix)
+{
+	if (!valid && !Next())
+		return false;
+
+	while (valid)
+	{
+		if (StartsWith(prefix.GetPattern()))
+			return true;
+		else if (!stopPrefix.IsEmpty() && StartsWith(stopPrefix.GetPattern()))
+			return false;
+
+		// Jump directly to the next occurrence of either pattern, unless there is a comment or raw text element
+		// in between.  Those need to be stepped over properly, since they may contain text that looks like a tag.
+		const size_type position(GetResumePosition());
+		size_type target(prefix.Find(html, position));
+		if (!stopPrefix.IsEmpty())
+			target = std::min(target, stopPrefix.Find(html, position));
+		if (target == std::string_view::npos)
+		{
+			Seek(html.length());
+			return false;
+		}
+
+		const std::string_view skippedText(html.substr(0, target));
+		const size_type hazard(std::min({ commentStart.Find(skippedText, position),
+			scriptStart.Find(skippedText, position), styleStart.Find(skippedText, position) }));
+		Seek(std::min(target, hazard));
+	}
+
+	return false;
+}
+
+bool HTMLTagScanner::ExtractContent(std::string_view& content)
+{
+	if (!valid || endTag)
+		return false;
+
+	const std::string_view startName(name);
+	const size_type contentStart(tagEnd);
+	while (Next())
+	{
+		if (endTag && NamesMatch(name, startName))
+		{
+			content = html.substr(contentStart, tagStart - contentStart);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool HTMLTagScanner::ExtractAfterPrefix(const PatternSearcher& prefix, std::string_view terminator, std::string_view& value) const
+{
+	if (!valid || !StartsWith(prefix.GetPattern()))
+		return false;
+
+	const auto start(tagStart + prefix.GetPattern().length());
+	const auto end(PatternSearcher(terminator).Find(html, start));
+	if (end == std::string_view::npos)
+		return false;
+
+	value = html.substr(start, end - start);
+	return true;
+}
+
+bool HTMLTagScanner::NamesMatch(std::string_view a, std::string_view b)
+{
+	if (a.length() != b.length())
+		return false;
+
+	for (size_type i = 0; i < a.length(); ++i)
+	{
+		if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i])))
+			return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,68 @@
+// File:  htmlTagScanner.h
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Forward-only tokenizer that steps from tag to tag through an HTML buffer.
+//        Nothing is copied - tags and text are returned as views into the buffer.
+
+#ifndef HTML_TAG_SCANNER_H_
+#define HTML_TAG_SCANNER_H_
+
+// Local headers
+#include "patternSearcher.h"
+
+// Standard C++ headers
+#include <string_view>
+
+class HTMLTagScanner
+{
+public:
+	typedef std::string_view::size_type size_type;
+
+	// The buffer must outlive the scanner
+	explicit HTMLTagScanner(std::string_view html) : html(html) {}
+
+	// Advances to the next tag (comments and doctypes are skipped).  Returns false at the end of the buffer.
+	bool Next();
+
+	// Advances until a tag starting with the specified text is found (the tag itself is checked first).
+	// If stopPrefix is specified, the search gives up (without moving past it) at a tag starting with that text.
+	// Intervening tags are jumped over rather than visited one at a time.
+	bool SkipTo(const PatternSearcher& prefix, const PatternSearcher& stopPrefix = PatternSearcher());
+
+	// Returns everything between the end of the current tag and the first following end tag with the
+	// current tag's name, and leaves the scanner on that end tag.
+	bool ExtractContent(std::string_view& content);
+
+	// Returns the text between the end of the specified prefix and the first following occurrence of the
+	// terminator.  Used for reading attribute values, e.g. title="Protocol: <value>".
+	bool ExtractAfterPrefix(const PatternSearcher& prefix, std::string_view terminator, std::string_view& value) const;
+
+	bool StartsWith(std::string_view prefix) const { return html.compare(tagStart, prefix.length(), prefix) == 0; }
+	bool IsEndTag() const { return endTag; }
+	bool IsValid() const { return valid; }
+	size_type GetTagStart() const { return tagStart; }
+	size_type GetTagEnd() const { return tagEnd; }// One past the '>'
+	std::string_view GetName() const { return name; }
+
+	static bool NamesMatch(std::string_view a, std::string_view b);// Case insensitive
+
+private:
+	const std::string_view html;
+
+	bool valid = false;
+	size_type tagStart = 0;
+	size_type tagEnd = 0;// One past the '>'
+	bool endTag = false;
+	std::string_view name;
+
+	static const PatternSearcher commentStart;
+	static const PatternSearcher scriptStart;
+	static const PatternSearcher styleStart;
+
+	bool Seek(const size_type& position);
+	size_type GetResumePosition();
+	size_type FindTagEnd(size_type position) const;
+	void SkipRawText();
+};
+
+#endif// HTML_TAG_SCANNER_H_
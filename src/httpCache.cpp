@@ -0,0 +1,349 @@
+// File:  httpCache.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Persistent cache of HTTP responses, keyed by normalized URL, with validators
+//        for conditional requests and least-recently-used eviction.
+
+// Local headers
+#include "httpCache.h"
+
+// Standard C++ headers
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <vector>
+#include <cctype>
+
+#if defined(_MSC_VER) && _MSC_VER < 1914
+#define filesystem experimental::filesystem
+#endif
+
+const std::string HTTPCache::fileHeader("eBirdCompilerHTTPCache 1");
+const std::string HTTPCache::fileExtension(".cache");
+
+HTTPCache::HTTPCache(const std::string& directory, const std::chrono::seconds& timeToLive, const std::uintmax_t& maxSize)
+	: directory(directory), timeToLive(timeToLive), maxSize(maxSize)
+{
+}
+
+bool HTTPCache::Load(const std::string& url, Entry& entry)
+{
+	const std::string normalizedURL(NormalizeURL(url));
+	const std::string fileName(GetFileName(normalizedURL));
+	
+	std::lock_guard<std::mutex> lock(mutex);
+	LoadIndex();
+	if (index.find(fileName) == index.end())
+		return false;
+		
+	if (!ReadEntry(fileName, entry) || entry.url != normalizedURL)// URL mismatch means a hash collision
+		return false;
+		
+	Touch(fileName);
+	return true;
+}
+
+bool HTTPCache::Store(const std::string& url, const std::string& body, const std::string& eTag, const std::string& lastModified)
+{
+	const std::string normalizedURL(NormalizeURL(url));
+	const std::string fileName(GetFileName(normalizedURL));
+	
+	std::lock_guard<std::mutex> lock(mutex);
+	LoadIndex();
+	
+	std::error_code ec;
+	std::filesystem::create_directories(directory, ec);
+	if (!WriteEntry(fileName, normalizedURL, body, eTag, lastModified, Now()))
+		return false;
+		
+	return AddToIndex(fileName);
+}
+
+std::unique_ptr<HTTPCache::Writer> HTTPCache::BeginStore(const std::string& url, const std::string& eTag, const std::string& lastModified)
+{
+	const std::string normalizedURL(NormalizeURL(url));
+	const std::string fileName(GetFileName(normalizedURL));
+	
+	std::string temporaryFileName;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		temporaryFileName = fileName + '.' + std::to_string(++writerCount) + ".partial";
+	}
+	
+	std::error_code ec;
+	std::filesystem::create_directories(directory, ec);
+	std::unique_ptr<Writer> writer(new Writer(fileName, temporaryFileName));
+	if (!writer->file.good())
+		return nullptr;
+		
+	// Body length isn't known yet, so leave a fixed-width field to fill in when we're done
+	WriteHeader(writer->file, normalizedURL, eTag, lastModified, Now());
+	writer->lengthPosition = writer->file.tellp();
+	writer->file << std::setw(20) << std::setfill('0') << 0 << '\n';
+	if (!writer->file.good())
+		return nullptr;
+	return writer;
+}
+
+bool HTTPCache::Commit(Writer& writer)
+{
+	writer.file.seekp(writer.lengthPosition);
+	writer.file << std::setw(20) << std::setfill('0') << writer.bodyLength;
+	writer.file.close();
+	if (writer.file.fail())
+		return false;
+		
+	std::lock_guard<std::mutex> lock(mutex);
+	LoadIndex();
+	
+	std::error_code ec;
+	std::filesystem::rename(writer.temporaryFileName, writer.fileName, ec);
+	if (ec)
+		return false;
+		
+	writer.committed = true;
+	return AddToIndex(writer.fileName);
+}
+
+HTTPCache::Writer::Writer(const std::string& fileName, const std::string& temporaryFileName)
+	: fileName(fileName), temporaryFileName(temporaryFileName), file(temporaryFileName, std::ios::binary | std::ios::trunc)
+{
+}
+
+HTTPCache::Writer::~Writer()
+{
+	if (committed)
+		return;
+		
+	file.close();
+	std::error_code ec;
+	std::filesystem::remove(temporaryFileName, ec);
+}
+
+bool HTTPCache::Writer::Append(std::string_view data)
+{
+	bodyLength += data.length();
+	return file.write(data.data(), data.length()).good();
+}
+
+bool HTTPCache::AddToIndex(const std::string& fileName)
+{
+	Remove(fileName);// Only from the index - the file was just overwritten
+	std::error_code ec;
+	const auto size(std::filesystem::file_size(fileName, ec));
+	if (ec)
+		return false;
+		
+	IndexEntry& indexEntry(index[fileName]);
+	indexEntry.size = size;
+	indexEntry.lastUse = LastUseNow();
+	totalSize += size;
+	
+	Evict(fileName);
+	return true;
+}
+
+bool HTTPCache::IsFresh(const Entry& entry) const
+{
+	return Now() - entry.storedTime < timeToLive.count();
+}
+
+void HTTPCache::SetMaxSize(const std::uintmax_t& newMaxSize)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	maxSize = newMaxSize;
+	if (indexLoaded)
+		Evict(std::string());
+}
+
+std::string HTTPCache::NormalizeURL(const std::string& url)
+{
+	std::string normalized(url);
+	normalized.erase(std::remove_if(normalized.begin(), normalized.end(), [](const unsigned char& c)
+	{
+		return std::isspace(c);
+	}), normalized.end());
+	
+	const auto fragment(normalized.find('#'));
+	if (fragment != std::string::npos)
+		normalized.erase(fragment);
+		
+	// Scheme and host are case-insensitive; the path is not
+	std::string::size_type hostStart(normalized.find("://"));
+	if (hostStart == std::string::npos)
+	{
+		normalized.insert(0, "https://");
+		hostStart = 5;
+	}
+	hostStart += 3;
+	
+	std::string::size_type hostEnd(normalized.find_first_of("/?", hostStart));
+	if (hostEnd == std::string::npos)
+		hostEnd = normalized.length();
+	std::transform(normalized.begin(), normalized.begin() + hostEnd, normalized.begin(), [](const unsigned char& c)
+	{
+		return static_cast<char>(std::tolower(c));
+	});
+	
+	const std::string scheme(normalized.substr(0, hostStart - 3));
+	const std::string defaultPort(scheme == "http" ? ":80" : (scheme == "https" ? ":443" : ""));
+	if (!defaultPort.empty() && hostEnd >= defaultPort.length() &&
+		normalized.compare(hostEnd - defaultPort.length(), defaultPort.length(), defaultPort) == 0)
+	{
+		normalized.erase(hostEnd - defaultPort.length(), defaultPort.length());
+		hostEnd -= defaultPort.length();
+	}
+	
+	if (hostEnd == normalized.length() || normalized[hostEnd] != '/')
+		normalized.insert(hostEnd, "/");
+		
+	return normalized;
+}
+
+void HTTPCache::LoadIndex()
+{
+	if (indexLoaded)
+		return;
+	indexLoaded = true;
+	
+	std::error_code ec;
+	for (std::filesystem::directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec))
+	{
+		if (!it->is_regular_file(ec) || it->path().extension() != fileExtension)
+			continue;
+			
+		IndexEntry entry;
+		entry.size = it->file_size(ec);
+		if (ec)
+			continue;
+			
+		const auto lastWrite(it->last_write_time(ec));
+		if (ec)
+			continue;
+		entry.lastUse = lastWrite.time_since_epoch().count();
+		
+		index[it->path().string()] = entry;
+		totalSize += entry.size;
+	}
+	
+	Evict(std::string());
+}
+
+void HTTPCache::Touch(const std::string& fileName)
+{
+	auto it(index.find(fileName));
+	if (it == index.end())
+		return;
+		
+	it->second.lastUse = LastUseNow();
+	
+	// File modification time serves as the last-use time across sessions
+	std::error_code ec;
+	std::filesystem::last_write_time(fileName, std::filesystem::file_time_type(std::filesystem::file_time_type::duration(it->second.lastUse)), ec);
+}
+
+void HTTPCache::Evict(const std::string& keepFileName)
+{
+	if (totalSize <= maxSize)
+		return;
+		
+	std::vector<std::pair<std::int64_t, std::string>> byLastUse;
+	for (const auto& entry : index)
+	{
+		if (entry.first != keepFileName)
+			byLastUse.push_back(std::make_pair(entry.second.lastUse, entry.first));
+	}
+	
+	std::sort(byLastUse.begin(), byLastUse.end());
+	for (const auto& entry : byLastUse)
+	{
+		if (totalSize <= maxSize)
+			break;
+			
+		std::error_code ec;
+		std::filesystem::remove(entry.second, ec);
+		Remove(entry.second);
+	}
+}
+
+void HTTPCache::Remove(const std::string& fileName)
+{
+	auto it(index.find(fileName));
+	if (it == index.end())
+		return;
+		
+	totalSize -= it->second.size;
+	index.erase(it);
+}
+
+std::string HTTPCache::GetFileName(const std::string& normalizedURL) const
+{
+	// 64-bit FNV-1a
+	std::uint64_t hash(14695981039346656037ull);
+	for (const auto& c : normalizedURL)
+	{
+		hash ^= static_cast<unsigned char>(c);
+		hash *= 1099511628211ull;
+	}
+	
+	std::ostringstream ss;
+	ss << std::hex << std::setw(16) << std::setfill('0') << hash;
+	return (std::filesystem::path(directory) / (ss.str() + fileExtension)).string();
+}
+
+bool HTTPCache::ReadEntry(const std::string& fileName, Entry& entry)
+{
+	std::ifstream file(fileName, std::ios::binary);
+	if (!file.good())
+		return false;
+		
+	std::string header;
+	std::string::size_type bodyLength;
+	if (!std::getline(file, header) || header != fileHeader ||
+		!std::getline(file, entry.url) ||
+		!std::getline(file, entry.eTag) ||
+		!std::getline(file, entry.lastModified) ||
+		(file >> entry.storedTime >> bodyLength).fail() ||
+		file.get() != '\n')
+		return false;
+		
+	entry.body.resize(bodyLength);
+	return !file.read(&entry.body[0], bodyLength).fail();
+}
+
+bool HTTPCache::WriteEntry(const std::string& fileName, const std::string& normalizedURL, const std::string& body,
+	const std::string& eTag, const std::string& lastModified, const std::int64_t& storedTime)
+{
+	std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+	if (!file.good())
+		return false;
+		
+	WriteHeader(file, normalizedURL, eTag, lastModified, storedTime);
+	file << body.length() << '\n';
+	file.write(body.data(), body.length());
+	return file.good();
+}
+
+// Everything but the body length, which follows on the same line
+void HTTPCache::WriteHeader(std::ostream& file, const std::string& normalizedURL, const std::string& eTag,
+	const std::string& lastModified, const std::int64_t& storedTime)
+{
+	file << fileHeader << '\n'
+		<< normalizedURL << '\n'
+		<< eTag << '\n'
+		<< lastModified << '\n'
+		<< storedTime << ' ';
+}
+
+std::int64_t HTTPCache::Now()
+{
+	return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+std::int64_t HTTPCache::LastUseNow()
+{
+	// Uses the file clock (rather than the system clock) so it can be compared with file modification times
+	return std::filesystem::file_time_type::clock::now().time_since_epoch().count();
+}
@@ -0,0 +1,105 @@
+// File:  httpCache.h
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Persistent cache of HTTP responses, keyed by normalized URL, with validators
+//        for conditional requests and least-recently-used eviction.
+
+#ifndef HTTP_CACHE_H_
+#define HTTP_CACHE_H_
+
+// Standard C++ headers
+#include <string>
+#include <chrono>
+#include <mutex>
+#include <unordered_map>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string_view>
+
+class HTTPCache
+{
+public:
+	HTTPCache(const std::string& directory, const std::chrono::seconds& timeToLive, const std::uintmax_t& maxSize);
+	
+	struct Entry
+	{
+		std::string url;// Normalized
+		std::string body;
+		std::string eTag;
+		std::string lastModified;
+		std::int64_t storedTime = 0;// [sec since epoch]
+	};
+	
+	bool Load(const std::string& url, Entry& entry);
+	// Also restarts the time-to-live for existing entries (i.e. after a 304 response)
+	bool Store(const std::string& url, const std::string& body, const std::string& eTag, const std::string& lastModified);
+	
+	// For bodies which are passed along as they arrive instead of being collected.  The body is written to a
+	// temporary file as it comes in, which replaces the URL's entry once committed (and is removed otherwise).
+	class Writer
+	{
+	public:
+		~Writer();
+		bool Append(std::string_view data);
+		
+	private:
+		friend class HTTPCache;
+		Writer(const std::string& fileName, const std::string& temporaryFileName);
+		
+		const std::string fileName;
+		const std::string temporaryFileName;
+		std::ofstream file;
+		std::streampos lengthPosition;
+		std::uintmax_t bodyLength = 0;
+		bool committed = false;
+	};
+	
+	std::unique_ptr<Writer> BeginStore(const std::string& url, const std::string& eTag, const std::string& lastModified);
+	bool Commit(Writer& writer);
+	
+	bool IsFresh(const Entry& entry) const;
+	bool HasValidators(const Entry& entry) const { return !entry.eTag.empty() || !entry.lastModified.empty(); }
+	
+	void SetTimeToLive(const std::chrono::seconds& newTimeToLive) { timeToLive = newTimeToLive; }
+	void SetMaxSize(const std::uintmax_t& newMaxSize);
+	
+	static std::string NormalizeURL(const std::string& url);
+
+private:
+	static const std::string fileHeader;
+	static const std::string fileExtension;
+
+	const std::string directory;
+	std::chrono::seconds timeToLive;
+	std::uintmax_t maxSize;// [bytes]
+	
+	struct IndexEntry
+	{
+		std::uintmax_t size;
+		std::int64_t lastUse;// [file clock ticks]
+	};
+	
+	std::mutex mutex;
+	bool indexLoaded = false;
+	std::unordered_map<std::string, IndexEntry> index;// Keyed by file name
+	std::uintmax_t totalSize = 0;
+	unsigned int writerCount = 0;// For naming temporary files
+	
+	void LoadIndex();// Caller must hold mutex
+	void Touch(const std::string& fileName);// Caller must hold mutex
+	void Evict(const std::string& keepFileName);// Caller must hold mutex
+	void Remove(const std::string& fileName);// Caller must hold mutex
+	bool AddToIndex(const std::string& fileName);// Caller must hold mutex
+	
+	std::string GetFileName(const std::string& normalizedURL) const;
+	static bool ReadEntry(const std::string& fileName, Entry& entry);
+	static void WriteHeader(std::ostream& file, const std::string& normalizedURL, const std::string& eTag,
+		const std::string& lastModified, const std::int64_t& storedTime);
+	static bool WriteEntry(const std::string& fileName, const std::string& normalizedURL, const std::string& body,
+		const std::string& eTag, const std::string& lastModified, const std::int64_t& storedTime);
+	static std::int64_t Now();
+	static std::int64_t LastUseNow();
+};
+
+#endif// HTTP_CACHE_H_
@@ -0,0 +1,247 @@
+// File:  instrumentation.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Process-wide timing spans and counters for the stages of a compile, summarized as
+//        per-stage histograms (JSON) or written as a Chrome trace.  While disabled, recording
+//        costs one atomic load.
+
+// Local headers
+#include "instrumentation.h"
+
+// Standard C++ headers
+#include <sstream>
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+
+std::atomic<bool> Instrumentation::enabled(false);
+const std::size_t Instrumentation::maxEvents(1000000);
+
+Instrumentation::State& Instrumentation::GetState()
+{
+	static State state;
+	return state;
+}
+
+void Instrumentation::Enable(const bool& enable)
+{
+	if (enable)
+		Clear();
+	enabled = enable;
+}
+
+void Instrumentation::Clear()
+{
+	State& state(GetState());
+	std::lock_guard<std::mutex> lock(state.mutex);
+	state.origin = Clock::now();
+	state.stages.clear();
+	state.counters.clear();
+	state.events.clear();
+	state.droppedEvents = 0;
+	state.threadTracks.clear();
+	state.namedTracks.clear();
+	state.trackNames.clear();
+}
+
+void Instrumentation::Span::End()
+{
+	if (!stage)
+		return;
+
+	AddSpan(stage, start, Clock::now());
+	stage = nullptr;
+}
+
+void Instrumentation::AddSpan(const std::string& stage, const Clock::time_point& start, const Clock::time_point& end, const std::string& track)
+{
+	if (!IsEnabled())
+		return;
+
+	const Clock::duration duration(std::max(end - start, Clock::duration(0)));
+	State& state(GetState());
+	std::lock_guard<std::mutex> lock(state.mutex);
+	StageStatistics& stats(state.stages[stage]);
+	++stats.count;
+	stats.total += duration;
+	stats.minimum = std::min(stats.minimum, duration);
+	stats.maximum = std::max(stats.maximum, duration);
+	++stats.histogram[GetBucket(duration)];
+
+	Event event;
+	event.name = stage;
+	event.track = GetTrack(state, track);
+	event.isCounter = false;
+	event.start = start - state.origin;
+	event.duration = duration;
+	event.counterTotal = 0;
+	AddEvent(state, std::move(event));
+}
+
+void Instrumentation::AddCount(const char* counter, const std::uint64_t& value)
+{
+	State& state(GetState());
+	std::lock_guard<std::mutex> lock(state.mutex);
+	std::uint64_t& total(state.counters[counter]);
+	total += value;
+
+	// Counter events carry the running total, which the trace viewer plots over time
+	Event event;
+	event.name = counter;
+	event.track = 0;
+	event.isCounter = true;
+	event.start = Clock::now() - state.origin;
+	event.duration = Clock::duration(0);
+	event.counterTotal = total;
+	AddEvent(state, std::move(event));
+}
+
+void Instrumentation::AddEvent(State& state, Event event)
+{
+	if (state.events.size() < maxEvents)
+		state.events.push_back(std::move(event));
+	else
+		++state.droppedEvents;
+}
+
+unsigned int Instrumentation::GetTrack(State& state, const std::string& track)
+{
+	if (track.empty())
+	{
+		const auto id(std::this_thread::get_id());
+		auto it(state.threadTracks.find(id));
+		if (it != state.threadTracks.end())
+			return it->second;
+
+		const unsigned int newTrack(static_cast<unsigned int>(state.trackNames.size()));
+		state.trackNames.push_back("thread " + std::to_string(state.threadTracks.size() + 1));
+		state.threadTracks[id] = newTrack;
+		return newTrack;
+	}
+
+	auto it(state.namedTracks.find(track));
+	if (it != state.namedTracks.end())
+		return it->second;
+
+	const unsigned int newTrack(static_cast<unsigned int>(state.trackNames.size()));
+	state.trackNames.push_back(track);
+	state.namedTracks[track] = newTrack;
+	return newTrack;
+}
+
+std::size_t Instrumentation::GetBucket(const Clock::duration& duration)
+{
+	auto microseconds(std::chrono::duration_cast<std::chrono::microseconds>(duration).count());
+	std::size_t bucket(0);
+	const std::size_t lastBucket(StageStatistics().histogram.size() - 1);
+	while (microseconds > 0 && bucket < lastBucket)
+	{
+		microseconds >>= 1;
+		++bucket;
+	}
+
+	return bucket;
+}
+
+std::string Instrumentation::GetJSON()
+{
+	auto seconds([](const Clock::duration& d)
+	{
+		return std::chrono::duration<double>(d).count();
+	});
+
+	State& state(GetState());
+	std::lock_guard<std::mutex> lock(state.mutex);
+	std::ostringstream ss;
+	ss << std::setprecision(9) << "{\n  \"stages\": {";
+	for (auto it = state.stages.begin(); it != state.stages.end(); ++it)
+	{
+		const StageStatistics& stats(it->second);
+		ss << (it == state.stages.begin() ? "\n" : ",\n") << "    \"" << Escape(it->first) << "\": {"
+			<< "\"count\": " << stats.count
+			<< ", \"totalSeconds\": " << seconds(stats.total)
+			<< ", \"meanSeconds\": " << seconds(stats.total) / stats.count
+			<< ", \"minSeconds\": " << seconds(stats.minimum)
+			<< ", \"maxSeconds\": " << seconds(stats.maximum)
+			<< ", \"histogram\": [";
+
+		// Buckets are reported by their upper bound, and empty buckets are skipped
+		bool first(true);
+		for (std::size_t i = 0; i < stats.histogram.size(); ++i)
+		{
+			if (stats.histogram[i] == 0)
+				continue;
+			ss << (first ? "" : ", ") << "{\"lessThanMicroseconds\": " << (std::uint64_t(1) << i) << ", \"count\": " << stats.histogram[i] << '}';
+			first = false;
+		}
+		ss << "]}";
+	}
+
+	ss << "\n  },\n  \"counters\": {";
+	for (auto it = state.counters.begin(); it != state.counters.end(); ++it)
+		ss << (it == state.counters.begin() ? "\n" : ",\n") << "    \"" << Escape(it->first) << "\": " << it->second;
+	ss << "\n  },\n  \"droppedTraceEvents\": " << state.droppedEvents << "\n}\n";
+	return ss.str();
+}
+
+std::string Instrumentation::GetChromeTrace()
+{
+	auto microseconds([](const Clock::duration& d)
+	{
+		return std::chrono::duration<double, std::micro>(d).count();
+	});
+
+	State& state(GetState());
+	std::lock_guard<std::mutex> lock(state.mutex);
+	std::ostringstream ss;
+	ss << std::fixed << std::setprecision(3) << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+	ss << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 0, \"args\": {\"name\": \"eBirdCompiler\"}}";
+	for (std::size_t i = 0; i < state.trackNames.size(); ++i)
+		ss << ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << i + 1 << ", \"args\": {\"name\": \"" << Escape(state.trackNames[i]) << "\"}}";
+
+	for (const auto& e : state.events)
+	{
+		ss << ",\n{\"name\": \"" << Escape(e.name) << "\", \"pid\": 1, \"ts\": " << microseconds(e.start);
+		if (e.isCounter)
+			ss << ", \"ph\": \"C\", \"tid\": 0, \"args\": {\"total\": " << e.counterTotal << "}}";
+		else
+			ss << ", \"ph\": \"X\", \"tid\": " << e.track + 1 << ", \"dur\": " << microseconds(e.duration) << '}';
+	}
+
+	ss << "\n]}\n";
+	return ss.str();
+}
+
+bool Instrumentation::WriteJSON(const std::string& fileName)
+{
+	return WriteFile(fileName, GetJSON());
+}
+
+bool Instrumentation::WriteChromeTrace(const std::string& fileName)
+{
+	return WriteFile(fileName, GetChromeTrace());
+}
+
+bool Instrumentation::WriteFile(const std::string& fileName, const std::string& contents)
+{
+	std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+		return false;
+	file << contents;
+	return file.good();
+}
+
+std::string Instrumentation::Escape(const std::string& s)
+{
+	std::string escaped;
+	for (const auto& c : s)
+	{
+		if (c == '"' || c == '\\')
+			escaped.push_back('\\');
+		else if (static_cast<unsigned char>(c) < 0x20)
+			continue;
+		escaped.push_back(c);
+	}
+
+	return escaped;
+}
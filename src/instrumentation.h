@@ -0,0 +1,119 @@
+// File:  instrumentation.h
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Process-wide timing spans and counters for the stages of a compile, summarized as
+//        per-stage histograms (JSON) or written as a Chrome trace.  While disabled, recording
+//        costs one atomic load.
+
+#ifndef INSTRUMENTATION_H_
+#define INSTRUMENTATION_H_
+
+// Standard C++ headers
+#include <string>
+#include <chrono>
+#include <atomic>
+#include <mutex>
+#include <map>
+#include <vector>
+#include <array>
+#include <thread>
+#include <cstdint>
+
+class Instrumentation
+{
+public:
+	typedef std::chrono::steady_clock Clock;
+
+	// Enabling discards anything recorded previously
+	static void Enable(const bool& enable = true);
+	static bool IsEnabled() { return enabled.load(std::memory_order_relaxed); }
+	static void Clear();
+
+	// Records the time from construction until End() (or destruction) as one sample of the stage.
+	// Stage names must be string literals (or otherwise outlive the span).
+	class Span
+	{
+	public:
+		explicit Span(const char* stage) : stage(IsEnabled() ? stage : nullptr)
+		{
+			if (this->stage)
+				start = Clock::now();
+		}
+
+		~Span() { End(); }
+		void End();
+
+	private:
+		const char* stage;
+		Clock::time_point start;
+	};
+
+	// For spans measured by someone else (i.e. libcurl).  Spans on the same track must nest, so
+	// overlapping activity from a single thread (concurrent transfers) should go on separate tracks.
+	// An empty track means the calling thread.
+	static void AddSpan(const std::string& stage, const Clock::time_point& start, const Clock::time_point& end, const std::string& track = std::string());
+
+	static void Count(const char* counter, const std::uint64_t& value = 1)
+	{
+		if (IsEnabled())
+			AddCount(counter, value);
+	}
+
+	// Per-stage count, total, extremes and a histogram of durations, plus counter totals
+	static std::string GetJSON();
+
+	// Chrome trace-event format (load with chrome://tracing or https://ui.perfetto.dev)
+	static std::string GetChromeTrace();
+
+	static bool WriteJSON(const std::string& fileName);
+	static bool WriteChromeTrace(const std::string& fileName);
+
+private:
+	static std::atomic<bool> enabled;
+	static const std::size_t maxEvents;// Beyond this, stage statistics are still kept but the trace is truncated
+
+	struct StageStatistics
+	{
+		std::uint64_t count = 0;
+		Clock::duration total = Clock::duration(0);
+		Clock::duration minimum = Clock::duration::max();
+		Clock::duration maximum = Clock::duration(0);
+		std::array<std::uint64_t, 32> histogram = {};// Bucket i holds durations in [2^(i-1), 2^i) microseconds
+	};
+
+	struct Event
+	{
+		std::string name;
+		unsigned int track;
+		bool isCounter;
+		Clock::duration start;// From origin
+		Clock::duration duration;
+		std::uint64_t counterTotal;
+	};
+
+	struct State
+	{
+		std::mutex mutex;
+		Clock::time_point origin = Clock::now();
+		std::map<std::string, StageStatistics> stages;
+		std::map<std::string, std::uint64_t> counters;
+		std::vector<Event> events;
+		std::uint64_t droppedEvents = 0;
+
+		std::map<std::thread::id, unsigned int> threadTracks;
+		std::map<std::string, unsigned int> namedTracks;
+		std::vector<std::string> trackNames;
+	};
+
+	static State& GetState();
+
+	static void AddCount(const char* counter, const std::uint64_t& value);
+	static void AddEvent(State& state, Event event);// Caller must hold mutex
+	static unsigned int GetTrack(State& state, const std::string& track);// Caller must hold mutex
+	static std::size_t GetBucket(const Clock::duration& duration);
+
+	static std::string Escape(const std::string& s);
+	static bool WriteFile(const std::string& fileName, const std::string& contents);
+};
+
+#endif// INSTRUMENTATION_H_
@@ -6,6 +6,15 @@
 // Local headers
 #include "mainFrame.h"
 #include "eBirdCompilerApp.h"
+#include "instrumentation.h"
+#include "sharedTaxonomy.h"
+
+// wxWidgets headers
+#include <wx/config.h>
+#include <wx/filename.h>
+
+// Standard C++ headers
+#include <algorithm>
 
 // *nix Icons
 #ifdef __WXGTK__
@@ -17,8 +26,10 @@
 #include "../res/icons/compiler128.xpm"
 #endif// __WXGTK__
 
+const wxString MainFrame::taxonomyConfigGroup(_T("/Taxonomy"));
+
 MainFrame::MainFrame() : wxFrame(nullptr, wxID_ANY, wxEmptyString,
-	wxDefaultPosition, wxDefaultSize, wxDEFAULT_FRAME_STYLE)
+	wxDefaultPosition, wxDefaultSize, wxDEFAULT_FRAME_STYLE), compiler(ReadTaxonomySettings())
 {
 	CreateControls();
 	SetProperties();
@@ -39,6 +50,12 @@ void MainFrame::CreateControls()
 	checklistTextBox = new wxTextCtrl(panel, idChecklistTextChange, wxEmptyString, wxDefaultPosition, wxSize(-1, 150), wxTE_MULTILINE | wxHSCROLL);
 	updateButton = new wxButton(panel, idButtonUpdate, _T("Update Summary"));
 	updateButton->Enable(false);
+	taxonomyButton = new wxButton(panel, idButtonTaxonomy, _T("Taxonomy..."));
+	taxonomyText = new wxStaticText(panel, wxID_ANY, wxEmptyString);
+	UpdateTaxonomyText();
+	recordTimingCheckBox = new wxCheckBox(panel, idRecordTiming, _T("Record timing"));
+	saveTimingButton = new wxButton(panel, idButtonSaveTiming, _T("Save Timing..."));
+	saveTimingButton->Enable(false);
 	summaryTextBox = new wxTextCtrl(panel, wxID_ANY, wxEmptyString, wxDefaultPosition, wxSize(800, 500), wxTE_MULTILINE | wxTE_READONLY | wxTE_RICH);
 
 	auto font(summaryTextBox->GetFont());
@@ -47,7 +64,14 @@ void MainFrame::CreateControls()
 	
 	mainSizer->Add(new wxStaticText(panel, wxID_ANY, _T("Enter checklist URLs:")), wxSizerFlags().Border(wxALL, 5));
 	mainSizer->Add(checklistTextBox, wxSizerFlags().Expand().Border(wxALL, 5));
-	mainSizer->Add(updateButton, wxSizerFlags().Border(wxALL, 5).Border(wxALL, 5));
+	wxSizer *buttonSizer = new wxBoxSizer(wxHORIZONTAL);
+	buttonSizer->Add(updateButton, wxSizerFlags().Border(wxALL, 5));
+	buttonSizer->Add(taxonomyButton, wxSizerFlags().Border(wxALL, 5));
+	buttonSizer->Add(taxonomyText, wxSizerFlags().Center().Border(wxALL, 5));
+	buttonSizer->AddStretchSpacer();
+	buttonSizer->Add(recordTimingCheckBox, wxSizerFlags().Center().Border(wxALL, 5));
+	buttonSizer->Add(saveTimingButton, wxSizerFlags().Border(wxALL, 5));
+	mainSizer->Add(buttonSizer, wxSizerFlags().Expand());
 	mainSizer->Add(new wxStaticText(panel, wxID_ANY, _T("Summary of observations:")), wxSizerFlags().Border(wxALL, 5));
 	mainSizer->Add(summaryTextBox, wxSizerFlags(1).Expand().Border(wxALL, 5));
 	
@@ -74,7 +98,10 @@ void MainFrame::SetProperties()
 
 BEGIN_EVENT_TABLE(MainFrame, wxFrame)
 	EVT_BUTTON(idButtonUpdate,			MainFrame::ButtonUpdateClickedEvent)
+	EVT_BUTTON(idButtonTaxonomy,		MainFrame::ButtonTaxonomyClickedEvent)
 	EVT_TEXT(idChecklistTextChange,		MainFrame::ChecklistTextChangeEvent)
+	EVT_CHECKBOX(idRecordTiming,		MainFrame::RecordTimingCheckBoxEvent)
+	EVT_BUTTON(idButtonSaveTiming,		MainFrame::ButtonSaveTimingClickedEvent)
 	EVT_COMMAND(wxID_ANY, THREAD_COMPLETE_EVENT, MainFrame::OnThreadCompleteEvent)
 END_EVENT_TABLE();
 
@@ -98,11 +125,106 @@ void MainFrame::ButtonUpdateClickedEvent(wxCommandEvent& WXUNUSED(event))
 	updateButton->Enable(false);
 }
 
+void MainFrame::ButtonTaxonomyClickedEvent(wxCommandEvent& WXUNUSED(event))
+{
+	const wxString wildcard(_T("eBird taxonomy (*.csv)|*.csv"));
+	wxFileDialog currentDialog(this, _T("Select Current Taxonomy"), wxEmptyString, wxEmptyString, wildcard, wxFD_OPEN | wxFD_FILE_MUST_EXIST);
+	if (currentDialog.ShowModal() != wxID_OK)
+		return;
+		
+	// Previous versions are optional, so cancelling this one just means there aren't any
+	wxFileDialog previousDialog(this, _T("Select Previous Taxonomy Versions (Optional)"), currentDialog.GetDirectory(), wxEmptyString,
+		wildcard, wxFD_OPEN | wxFD_FILE_MUST_EXIST | wxFD_MULTIPLE);
+	wxArrayString previousPaths;
+	if (previousDialog.ShowModal() == wxID_OK)
+		previousDialog.GetPaths(previousPaths);
+		
+	taxonomyFile = currentDialog.GetPath().ToStdString();
+	previousTaxonomyFiles.clear();
+	for (const auto& path : previousPaths)
+	{
+		if (path != currentDialog.GetPath())
+			previousTaxonomyFiles.push_back(path.ToStdString());
+	}
+	
+	// eBird's file names end with the version year, so sorting by name puts the most recent first
+	std::sort(previousTaxonomyFiles.begin(), previousTaxonomyFiles.end(), [](const std::string& a, const std::string& b)
+	{
+		return wxFileName(a).GetFullName() > wxFileName(b).GetFullName();
+	});
+	
+	compiler.SetTaxonomy(EBirdCompiler::CreateSharedTaxonomy(taxonomyFile, previousTaxonomyFiles));
+	WriteTaxonomySettings();
+	UpdateTaxonomyText();
+	
+	// The current summary was compiled against the old taxonomy
+	updateButton->Enable(!checklistTextBox->IsEmpty());
+}
+
+std::shared_ptr<SharedTaxonomy> MainFrame::ReadTaxonomySettings()
+{
+	wxConfigBase* config(wxConfigBase::Get());
+	wxString fileName;
+	if (!config->Read(taxonomyConfigGroup + _T("/Current"), &fileName) || fileName.IsEmpty())
+	{
+		taxonomyFile = EBirdCompiler::GetDefaultTaxonomyFileName();
+		return EBirdCompiler::CreateSharedTaxonomy();
+	}
+	
+	taxonomyFile = fileName.ToStdString();
+	while (config->Read(taxonomyConfigGroup + wxString::Format(_T("/Previous%zu"), previousTaxonomyFiles.size() + 1), &fileName))
+		previousTaxonomyFiles.push_back(fileName.ToStdString());
+		
+	return EBirdCompiler::CreateSharedTaxonomy(taxonomyFile, previousTaxonomyFiles);
+}
+
+void MainFrame::WriteTaxonomySettings() const
+{
+	wxConfigBase* config(wxConfigBase::Get());
+	config->DeleteGroup(taxonomyConfigGroup);
+	config->Write(taxonomyConfigGroup + _T("/Current"), wxString(taxonomyFile));
+	for (std::vector<std::string>::size_type i = 0; i < previousTaxonomyFiles.size(); ++i)
+		config->Write(taxonomyConfigGroup + wxString::Format(_T("/Previous%zu"), i + 1), wxString(previousTaxonomyFiles[i]));
+	config->Flush();
+}
+
+void MainFrame::UpdateTaxonomyText()
+{
+	wxString text(_T("Taxonomy:  ") + wxFileName(taxonomyFile).GetFullName());
+	if (previousTaxonomyFiles.size() == 1)
+		text += _T(" (+ 1 previous version)");
+	else if (previousTaxonomyFiles.size() > 1)
+		text += wxString::Format(_T(" (+ %zu previous versions)"), previousTaxonomyFiles.size());
+		
+	taxonomyText->SetLabel(text);
+	taxonomyText->SetToolTip(wxString(taxonomyFile));
+	Layout();
+}
+
 void MainFrame::ChecklistTextChangeEvent(wxCommandEvent& WXUNUSED(event))
 {
 	updateButton->Enable();
 }
 
+void MainFrame::RecordTimingCheckBoxEvent(wxCommandEvent& event)
+{
+	Instrumentation::Enable(event.IsChecked());
+	saveTimingButton->Enable(event.IsChecked());
+}
+
+void MainFrame::ButtonSaveTimingClickedEvent(wxCommandEvent& WXUNUSED(event))
+{
+	wxFileDialog dialog(this, _T("Save Timing"), wxEmptyString, _T("timing.json"),
+		_T("Chrome trace (*.json)|*.json|Stage statistics (*.json)|*.json"), wxFD_SAVE | wxFD_OVERWRITE_PROMPT);
+	if (dialog.ShowModal() != wxID_OK)
+		return;
+		
+	const std::string fileName(dialog.GetPath().ToStdString());
+	const bool saved(dialog.GetFilterIndex() == 0 ? Instrumentation::WriteChromeTrace(fileName) : Instrumentation::WriteJSON(fileName));
+	if (!saved)
+		wxMessageBox(_T("Failed to write '") + dialog.GetPath() + _T("'"), _T("Error"));
+}
+
 void MainFrame::OnThreadCompleteEvent(wxCommandEvent& event)
 {
 	busyInfo.reset();
@@ -17,6 +17,7 @@
 #include <vector>
 #include <memory>
 #include <thread>
+#include <string>
 
 wxDEFINE_EVENT(THREAD_COMPLETE_EVENT, wxCommandEvent);
 
@@ -35,19 +36,39 @@ private:
 	wxTextCtrl* summaryTextBox;
 	
 	wxButton* updateButton;
+	wxButton* taxonomyButton;
+	wxStaticText* taxonomyText;
+	wxCheckBox* recordTimingCheckBox;
+	wxButton* saveTimingButton;
 
 	// The event IDs
 	enum MainFrameEventID
 	{
 		idButtonUpdate = wxID_HIGHEST + 100,
-		idChecklistTextChange
+		idButtonTaxonomy,
+		idChecklistTextChange,
+		idRecordTiming,
+		idButtonSaveTiming
 	};
 
 	void ButtonUpdateClickedEvent(wxCommandEvent &event);
+	void ButtonTaxonomyClickedEvent(wxCommandEvent& event);
 	void ChecklistTextChangeEvent(wxCommandEvent& event);
+	void RecordTimingCheckBoxEvent(wxCommandEvent& event);
+	void ButtonSaveTimingClickedEvent(wxCommandEvent& event);
 	void OnThreadCompleteEvent(wxCommandEvent& event);
 	
 	void UpdateThreadEntry();
+	
+	// The taxonomy files chosen with the Taxonomy button are saved in the application's configuration
+	static const wxString taxonomyConfigGroup;
+	
+	std::string taxonomyFile;
+	std::vector<std::string> previousTaxonomyFiles;// Most recent first
+	
+	std::shared_ptr<SharedTaxonomy> ReadTaxonomySettings();// Fills in the members above while the compiler below is constructed, so they must be declared first
+	void WriteTaxonomySettings() const;
+	void UpdateTaxonomyText();
 
 	DECLARE_EVENT_TABLE();
 	
@@ -0,0 +1,104 @@
+// File:  memoryMappedFile.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Read-only memory mapping of a file.
+
+// Local headers
+#include "memoryMappedFile.h"
+
+#ifdef _WIN32
+// Windows headers
+#include <Windows.h>
+#else
+// *nix headers
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+	Close();
+}
+
+bool MemoryMappedFile::Open(const std::string& fileName)
+{
+	Close();
+	
+#ifdef _WIN32
+	fileHandle = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (fileHandle == INVALID_HANDLE_VALUE)
+	{
+		fileHandle = nullptr;
+		return false;
+	}
+	
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0)
+	{
+		Close();
+		return false;
+	}
+	
+	mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mappingHandle)
+	{
+		Close();
+		return false;
+	}
+	
+	data = static_cast<const char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+	if (!data)
+	{
+		Close();
+		return false;
+	}
+	
+	size = static_cast<std::size_t>(fileSize.QuadPart);
+#else
+	const int fd(open(fileName.c_str(), O_RDONLY));
+	if (fd < 0)
+		return false;
+		
+	struct stat fileStat;
+	if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0)
+	{
+		close(fd);
+		return false;
+	}
+	
+	void* mapping(mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0));
+	close(fd);// Mapping remains valid after the descriptor is closed
+	if (mapping == MAP_FAILED)
+		return false;
+		
+	data = static_cast<const char*>(mapping);
+	size = static_cast<std::size_t>(fileStat.st_size);
+#endif
+	
+	return true;
+}
+
+void MemoryMappedFile::Close()
+{
+#ifdef _WIN32
+	if (data)
+		UnmapViewOfFile(data);
+		
+	if (mappingHandle)
+		CloseHandle(mappingHandle);
+		
+	if (fileHandle)
+		CloseHandle(fileHandle);
+		
+	mappingHandle = nullptr;
+	fileHandle = nullptr;
+#else
+	if (data)
+		munmap(const_cast<char*>(data), size);
+#endif
+
+	data = nullptr;
+	size = 0;
+}
@@ -0,0 +1,39 @@
+// File:  memoryMappedFile.h
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Read-only memory mapping of a file.
+
+#ifndef MEMORY_MAPPED_FILE_H_
+#define MEMORY_MAPPED_FILE_H_
+
+// Standard C++ headers
+#include <string>
+#include <cstddef>
+
+class MemoryMappedFile
+{
+public:
+	MemoryMappedFile() = default;
+	~MemoryMappedFile();
+	
+	MemoryMappedFile(const MemoryMappedFile&) = delete;
+	MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+	
+	bool Open(const std::string& fileName);
+	void Close();
+	
+	bool IsOpen() const { return data != nullptr; }
+	const char* GetData() const { return data; }
+	std::size_t GetSize() const { return size; }
+
+private:
+	const char* data = nullptr;
+	std::size_t size = 0;
+	
+#ifdef _WIN32
+	void* fileHandle = nullptr;
+	void* mappingHandle = nullptr;
+#endif
+};
+
+#endif// MEMORY_MAPPED_FILE_H_
@@ -0,0 +1,151 @@
+// File:  pageArchive.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Collection of downloaded pages keyed by URL, saved as a single file (loosely modelled
+//        on WARC) so a set of checklists can be recorded once and replayed without a network.
+
+// Local headers
+#include "pageArchive.h"
+
+// Standard C++ headers
+#include <fstream>
+#include <sstream>
+
+// Each record is a block of headers, a blank line, the body, and another blank line (line endings are CRLF):
+//   URL: https://ebird.org/checklist/S12345678
+//   Content-Length: 123456
+const std::string PageArchive::fileHeader("eBirdCompilerArchive 1");
+
+bool PageArchive::Load(const std::string& fileName)
+{
+	std::ifstream file(fileName, std::ios::binary);
+	std::ostringstream ss;
+	if (!file.is_open() || !(ss << file.rdbuf()))
+	{
+		errorString = "Failed to read '" + fileName + "'";
+		return false;
+	}
+
+	const std::string contents(ss.str());
+	std::string::size_type position(0);
+	auto readLine([&contents, &position](std::string& line)
+	{
+		const auto end(contents.find("\r\n", position));
+		if (end == std::string::npos)
+			return false;
+		line = contents.substr(position, end - position);
+		position = end + 2;
+		return true;
+	});
+
+	std::string line;
+	if (!readLine(line) || line != fileHeader || !readLine(line) || !line.empty())
+	{
+		errorString = "'" + fileName + "' is not a page archive";
+		return false;
+	}
+
+	while (position < contents.length())
+	{
+		std::string url;
+		std::string::size_type length(std::string::npos);
+		while (readLine(line) && !line.empty())
+		{
+			const auto colon(line.find(": "));
+			if (colon == std::string::npos)
+				continue;
+
+			const std::string name(line.substr(0, colon));
+			if (name == "URL")
+				url = line.substr(colon + 2);
+			else if (name == "Content-Length")
+			{
+				std::istringstream lengthStream(line.substr(colon + 2));
+				if ((lengthStream >> length).fail())
+					length = std::string::npos;
+			}
+		}
+
+		if (url.empty() || length == std::string::npos || position + length + 4 > contents.length() ||
+			contents.compare(position + length, 4, "\r\n\r\n") != 0)
+		{
+			errorString = "Bad record in '" + fileName + "'";
+			return false;
+		}
+
+		Add(url, contents.substr(position, length));
+		position += length + 4;
+	}
+
+	return true;
+}
+
+bool PageArchive::Save(const std::string& fileName)
+{
+	std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+	{
+		errorString = "Failed to open '" + fileName + "' for writing";
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+	file << fileHeader << "\r\n\r\n";
+	for (const auto& p : pages)
+		file << "URL: " << p.first << "\r\nContent-Length: " << p.second->length() << "\r\n\r\n" << *p.second << "\r\n\r\n";
+
+	if (!file.good())
+	{
+		errorString = "Failed to write '" + fileName + "'";
+		return false;
+	}
+
+	return true;
+}
+
+void PageArchive::Add(const std::string& url, const std::string& body)
+{
+	auto page(std::make_shared<const std::string>(body));
+	std::lock_guard<std::mutex> lock(mutex);
+	pages[url] = page;
+	pagesByPath[GetPath(url)] = page;
+}
+
+std::shared_ptr<const std::string> PageArchive::Find(const std::string& url) const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	auto it(pages.find(url));
+	if (it != pages.end())
+		return it->second;
+
+	it = pagesByPath.find(GetPath(url));
+	if (it != pagesByPath.end())
+		return it->second;
+	return nullptr;
+}
+
+std::vector<std::string> PageArchive::GetURLs() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	std::vector<std::string> urls;
+	for (const auto& p : pages)
+		urls.push_back(p.first);
+	return urls;
+}
+
+std::size_t PageArchive::GetPageCount() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return pages.size();
+}
+
+std::string PageArchive::GetPath(const std::string& url)
+{
+	std::string::size_type hostStart(url.find("://"));
+	hostStart = hostStart == std::string::npos ? 0 : hostStart + 3;
+
+	const auto pathStart(url.find('/', hostStart));
+	if (pathStart == std::string::npos)
+		return "/";
+	return url.substr(pathStart);
+}
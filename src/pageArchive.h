@@ -0,0 +1,45 @@
+// File:  pageArchive.h
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Collection of downloaded pages keyed by URL, saved as a single file (loosely modelled
+//        on WARC) so a set of checklists can be recorded once and replayed without a network.
+
+#ifndef PAGE_ARCHIVE_H_
+#define PAGE_ARCHIVE_H_
+
+// Standard C++ headers
+#include <string>
+#include <map>
+#include <vector>
+#include <memory>
+#include <mutex>
+
+class PageArchive
+{
+public:
+	bool Load(const std::string& fileName);// Adds to any pages already in the archive
+	bool Save(const std::string& fileName);
+	std::string GetErrorString() const { return errorString; }
+
+	void Add(const std::string& url, const std::string& body);// Replaces any page already stored for the URL
+
+	// Pages are matched on the whole URL first, then on the path alone, so a page recorded from one host can be
+	// requested from another (i.e. a local server replaying the archive).  nullptr if there's no match.
+	std::shared_ptr<const std::string> Find(const std::string& url) const;
+
+	std::vector<std::string> GetURLs() const;
+	std::size_t GetPageCount() const;
+
+	static std::string GetPath(const std::string& url);// Everything after the host, including the leading slash
+
+private:
+	static const std::string fileHeader;
+
+	std::string errorString;
+
+	mutable std::mutex mutex;
+	std::map<std::string, std::shared_ptr<const std::string>> pages;// By URL
+	std::map<std::string, std::shared_ptr<const std::string>> pagesByPath;
+};
+
+#endif// PAGE_ARCHIVE_H_
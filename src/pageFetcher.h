@@ -0,0 +1,38 @@
+// File:  pageFetcher.h
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Interface for getting checklist pages, so where they come from (the web, saved pages, etc.)
+//        can be swapped out.
+
+#ifndef PAGE_FETCHER_H_
+#define PAGE_FETCHER_H_
+
+// Local headers
+#include "transferStatistics.h"
+
+// Standard C++ headers
+#include <string>
+#include <string_view>
+#include <vector>
+#include <functional>
+
+class PageFetcher
+{
+public:
+	virtual ~PageFetcher() = default;
+
+	virtual bool GetHTML(const std::string& url, std::string& html) = 0;
+
+	// The handler is called from the calling thread as each page completes; returning false cancels the remaining pages.
+	typedef std::function<bool(const std::vector<std::string>::size_type& index, const bool& success, std::string& html)> ResponseHandler;
+
+	// If a chunk handler is given, pages may be passed to it in pieces as they arrive instead of being collected, in
+	// which case the response handler then receives an empty page.  Returning false from the chunk handler fails the page.
+	typedef std::function<bool(const std::vector<std::string>::size_type& index, std::string_view data)> ChunkHandler;
+	virtual bool GetHTML(const std::vector<std::string>& urls, const ResponseHandler& handler, const ChunkHandler& chunkHandler) = 0;
+
+	// One record for each request sent over the network (empty if there is no network involved)
+	virtual const std::vector<TransferStatistics>& GetStatistics() const = 0;
+};
+
+#endif// PAGE_FETCHER_H_
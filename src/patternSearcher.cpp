@@ -0,0 +1,175 @@
+// File:  patternSearcher.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Substring search for fixed patterns.  Candidate positions are found by comparing the
+//        first and last bytes of the pattern against 16 or 32 bytes of text at a time (SSE2 or
+//        AVX2, chosen at run time), and only candidates are compared in full.
+
+// Local headers
+#include "patternSearcher.h"
+
+// Standard C++ headers
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PATTERN_SEARCHER_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(PATTERN_SEARCHER_SSE2) && (defined(__GNUC__) || defined(_MSC_VER))
+#define PATTERN_SEARCHER_AVX2
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define TARGET_AVX2
+#else
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+#ifdef PATTERN_SEARCHER_SSE2
+static unsigned int CountTrailingZeros(const unsigned int& mask)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return index;
+#else
+	return __builtin_ctz(mask);
+#endif
+}
+#endif
+
+#ifdef PATTERN_SEARCHER_AVX2
+static bool CPUSupportsAVX2()
+{
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7)
+		return false;
+
+	__cpuid(info, 1);
+	const bool osSavesYMMRegisters((info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6);
+	__cpuidex(info, 7, 0);
+	return osSavesYMMRegisters && (info[1] & (1 << 5)) != 0;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+PatternSearcher::size_type PatternSearcher::Find(std::string_view text, size_type position) const
+{
+	if (position > text.length() || pattern.length() > text.length() - position)
+		return std::string_view::npos;
+	else if (pattern.empty())
+		return position;
+
+	static const SearchFunction search(SelectSearchFunction());
+	const auto offset(search(text.data() + position, text.length() - position, pattern));
+	if (offset == std::string_view::npos)
+		return std::string_view::npos;
+	return offset + position;
+}
+
+PatternSearcher::InstructionSet PatternSearcher::GetInstructionSet()
+{
+#ifdef PATTERN_SEARCHER_AVX2
+	if (CPUSupportsAVX2())
+		return InstructionSet::AVX2;
+#endif
+#ifdef PATTERN_SEARCHER_SSE2
+	return InstructionSet::SSE2;
+#else
+	return InstructionSet::Scalar;
+#endif
+}
+
+PatternSearcher::SearchFunction PatternSearcher::SelectSearchFunction()
+{
+	switch (GetInstructionSet())
+	{
+#ifdef PATTERN_SEARCHER_AVX2
+	case InstructionSet::AVX2:
+		return &FindAVX2;
+#endif
+#ifdef PATTERN_SEARCHER_SSE2
+	case InstructionSet::SSE2:
+		return &FindSSE2;
+#endif
+	default:
+		return &FindScalar;
+	}
+}
+
+PatternSearcher::size_type PatternSearcher::FindScalar(const char* text, size_type length, std::string_view pattern)
+{
+	return std::string_view(text, length).find(pattern);
+}
+
+#ifdef PATTERN_SEARCHER_SSE2
+PatternSearcher::size_type PatternSearcher::FindSSE2(const char* text, size_type length, std::string_view pattern)
+{
+	if (pattern.length() == 1)
+		return FindScalar(text, length, pattern);// memchr is already vectorized
+
+	const size_type last(pattern.length() - 1);
+	const __m128i firstBytes(_mm_set1_epi8(pattern.front()));
+	const __m128i lastBytes(_mm_set1_epi8(pattern.back()));
+
+	size_type i(0);
+	for (; i + last + 16 <= length; i += 16)
+	{
+		const __m128i blockFirst(_mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i)));
+		const __m128i blockLast(_mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i + last)));
+		unsigned int mask(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(firstBytes, blockFirst), _mm_cmpeq_epi8(lastBytes, blockLast))));
+		while (mask != 0)
+		{
+			const unsigned int offset(CountTrailingZeros(mask));
+			if (std::memcmp(text + i + offset + 1, pattern.data() + 1, last - 1) == 0)
+				return i + offset;
+			mask &= mask - 1;
+		}
+	}
+
+	const auto tailPosition(FindScalar(text + i, length - i, pattern));
+	if (tailPosition == std::string_view::npos)
+		return std::string_view::npos;
+	return tailPosition + i;
+}
+#endif
+
+#ifdef PATTERN_SEARCHER_AVX2
+TARGET_AVX2 PatternSearcher::size_type PatternSearcher::FindAVX2(const char* text, size_type length, std::string_view pattern)
+{
+	if (pattern.length() == 1)
+		return FindScalar(text, length, pattern);
+
+	const size_type last(pattern.length() - 1);
+	const __m256i firstBytes(_mm256_set1_epi8(pattern.front()));
+	const __m256i lastBytes(_mm256_set1_epi8(pattern.back()));
+
+	size_type i(0);
+	for (; i + last + 32 <= length; i += 32)
+	{
+		const __m256i blockFirst(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i)));
+		const __m256i blockLast(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i + last)));
+		unsigned int mask(_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(firstBytes, blockFirst), _mm256_cmpeq_epi8(lastBytes, blockLast))));
+		while (mask != 0)
+		{
+			const unsigned int offset(CountTrailingZeros(mask));
+			if (std::memcmp(text + i + offset + 1, pattern.data() + 1, last - 1) == 0)
+				return i + offset;
+			mask &= mask - 1;
+		}
+	}
+
+	// Finish with the narrower search so short tails don't fall all the way back to scalar
+	const auto tailPosition(FindSSE2(text + i, length - i, pattern));
+	if (tailPosition == std::string_view::npos)
+		return std::string_view::npos;
+	return tailPosition + i;
+}
+#endif
@@ -0,0 +1,49 @@
+// File:  patternSearcher.h
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Substring search for fixed patterns.  Candidate positions are found by comparing the
+//        first and last bytes of the pattern against 16 or 32 bytes of text at a time (SSE2 or
+//        AVX2, chosen at run time), and only candidates are compared in full.
+
+#ifndef PATTERN_SEARCHER_H_
+#define PATTERN_SEARCHER_H_
+
+// Standard C++ headers
+#include <string_view>
+
+class PatternSearcher
+{
+public:
+	typedef std::string_view::size_type size_type;
+
+	// The pattern is not copied, so it must outlive the searcher (typically it's a literal)
+	constexpr PatternSearcher() = default;
+	constexpr explicit PatternSearcher(std::string_view pattern) : pattern(pattern) {}
+
+	// Returns the position of the first occurrence at or after position, or npos
+	size_type Find(std::string_view text, size_type position = 0) const;
+
+	std::string_view GetPattern() const { return pattern; }
+	bool IsEmpty() const { return pattern.empty(); }
+
+	enum class InstructionSet
+	{
+		Scalar,
+		SSE2,
+		AVX2
+	};
+
+	static InstructionSet GetInstructionSet();
+
+private:
+	std::string_view pattern;
+
+	typedef size_type (*SearchFunction)(const char* text, size_type length, std::string_view pattern);
+	static SearchFunction SelectSearchFunction();
+
+	static size_type FindScalar(const char* text, size_type length, std::string_view pattern);
+	static size_type FindSSE2(const char* text, size_type length, std::string_view pattern);
+	static size_type FindAVX2(const char* text, size_type length, std::string_view pattern);
+};
+
+#endif// PATTERN_SEARCHER_H_
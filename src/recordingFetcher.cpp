@@ -0,0 +1,55 @@
+// File:  recordingFetcher.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Passes requests through to another fetcher and adds every page it gets to a PageArchive,
+//        for replaying later with ArchiveFetcher or the replay server.
+
+// Local headers
+#include "recordingFetcher.h"
+#include "pageArchive.h"
+
+// Standard C++ headers
+#include <cassert>
+
+RecordingFetcher::RecordingFetcher(std::unique_ptr<PageFetcher> fetcher, std::shared_ptr<PageArchive> archive)
+	: fetcher(std::move(fetcher)), archive(archive)
+{
+	assert(this->fetcher && this->archive);
+}
+
+bool RecordingFetcher::GetHTML(const std::string& url, std::string& html)
+{
+	if (!fetcher->GetHTML(url, html))
+		return false;
+
+	archive->Add(url, html);
+	return true;
+}
+
+bool RecordingFetcher::GetHTML(const std::vector<std::string>& urls, const ResponseHandler& handler, const ChunkHandler& chunkHandler)
+{
+	// Both handlers are called from this thread, so the partial pages need no locking
+	std::map<std::vector<std::string>::size_type, std::string> streamedPages;
+	ChunkHandler recordingChunkHandler;
+	if (chunkHandler)
+	{
+		recordingChunkHandler = [&chunkHandler, &streamedPages](const std::vector<std::string>::size_type& index, std::string_view data)
+		{
+			streamedPages[index].append(data);
+			return chunkHandler(index, data);
+		};
+	}
+
+	auto recordingHandler([this, &urls, &handler, &streamedPages](const std::vector<std::string>::size_type& index, const bool& success, std::string& html)
+	{
+		const auto streamed(streamedPages.find(index));
+		if (success)
+			archive->Add(urls[index], streamed == streamedPages.end() ? html : streamed->second);
+		if (streamed != streamedPages.end())
+			streamedPages.erase(streamed);
+
+		return handler(index, success, html);
+	});
+
+	return fetcher->GetHTML(urls, recordingHandler, recordingChunkHandler);
+}
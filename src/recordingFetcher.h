@@ -0,0 +1,38 @@
+// File:  recordingFetcher.h
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Passes requests through to another fetcher and adds every page it gets to a PageArchive,
+//        for replaying later with ArchiveFetcher or the replay server.
+
+#ifndef RECORDING_FETCHER_H_
+#define RECORDING_FETCHER_H_
+
+// Local headers
+#include "pageFetcher.h"
+
+// Standard C++ headers
+#include <memory>
+#include <map>
+
+// Local forward declarations
+class PageArchive;
+
+class RecordingFetcher : public PageFetcher
+{
+public:
+	// The archive may be shared among several recording fetchers
+	RecordingFetcher(std::unique_ptr<PageFetcher> fetcher, std::shared_ptr<PageArchive> archive);
+
+	bool GetHTML(const std::string& url, std::string& html) override;
+
+	// Pages streamed to the chunk handler are also collected, so they can be recorded once complete
+	bool GetHTML(const std::vector<std::string>& urls, const ResponseHandler& handler, const ChunkHandler& chunkHandler) override;
+
+	const std::vector<TransferStatistics>& GetStatistics() const override { return fetcher->GetStatistics(); }
+
+private:
+	const std::unique_ptr<PageFetcher> fetcher;
+	const std::shared_ptr<PageArchive> archive;
+};
+
+#endif// RECORDING_FETCHER_H_
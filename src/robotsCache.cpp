@@ -0,0 +1,144 @@
+// File:  robotsCache.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Compiled robots.txt rules for each host, kept in memory and saved to disk so robots.txt
+//        is only downloaded again once the saved copy expires.
+
+// Local headers
+#include "robotsCache.h"
+#include "htmlRetriever.h"
+
+// Standard C++ headers
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <cctype>
+
+#if defined(_MSC_VER) && _MSC_VER < 1914
+#define filesystem experimental::filesystem
+#endif
+
+const std::string RobotsCache::fileHeader("eBirdCompilerRobotsCache 1");
+const std::string RobotsCache::fileExtension(".txt");
+const std::chrono::steady_clock::duration RobotsCache::fallbackCrawlDelay(std::chrono::seconds(1));
+
+RobotsCache::RobotsCache(const std::string& directory, const std::chrono::seconds& timeToLive)
+	: directory(directory), timeToLive(timeToLive)
+{
+}
+
+std::shared_ptr<const RobotsRules> RobotsCache::GetRules(HTMLRetriever& retriever, const std::string& url)
+{
+	const std::string host(HostRateLimiter::GetHost(url));
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		auto it(hosts.find(host));
+		if (it != hosts.end() && IsFresh(it->second))
+			return it->second.rules;
+
+		Entry entry;
+		if (ReadFile(host, retriever.GetUserAgent(), entry) && IsFresh(entry))
+		{
+			hosts[host] = entry;
+			return entry.rules;
+		}
+	}
+
+	// Download without holding the lock - if two threads race for the same host, both copies are the same anyway.
+	// Per RFC 9309, a 4xx response means there are no rules, but a server error (or no response) tells us nothing, so
+	// we fall back to a conservative crawl delay (as we do for 429, which asks us to slow down).  Only a 200 response
+	// is a robots.txt, and only that is saved.
+	std::string robotsTxt;
+	const bool retrieved(retriever.GetHTML(GetRobotsTxtURL(url), robotsTxt));
+	const long responseCode(retriever.GetLastResponseCode());
+	if (!retrieved || responseCode != 200)
+	{
+		auto rules(std::make_shared<RobotsRules>());
+		if (responseCode < 400 || responseCode >= 500 || responseCode == 429)
+			rules->SetCrawlDelay(fallbackCrawlDelay);
+		return rules;
+	}
+
+	Entry entry;
+	entry.rules = Compile(robotsTxt, retriever.GetUserAgent());
+	entry.fetchTime = Now();
+
+	std::lock_guard<std::mutex> lock(mutex);
+	WriteFile(host, robotsTxt, entry.fetchTime);
+	hosts[host] = entry;
+	return entry.rules;
+}
+
+bool RobotsCache::IsRobotsTxtURL(const std::string& url)
+{
+	return RobotsRules::GetPath(url) == "/robots.txt";
+}
+
+std::string RobotsCache::GetRobotsTxtURL(const std::string& url)
+{
+	std::string::size_type hostStart(url.find("://"));
+	hostStart = hostStart == std::string::npos ? 0 : hostStart + 3;
+	return url.substr(0, url.find_first_of("/?#", hostStart)) + "/robots.txt";
+}
+
+bool RobotsCache::IsFresh(const Entry& entry) const
+{
+	return Now() - entry.fetchTime < timeToLive.count();
+}
+
+bool RobotsCache::ReadFile(const std::string& host, const std::string& userAgent, Entry& entry) const
+{
+	std::ifstream file(GetFileName(host), std::ios::binary);
+	if (!file.good())
+		return false;
+
+	std::string header;
+	if (!std::getline(file, header) || header != fileHeader ||
+		(file >> entry.fetchTime).fail() ||
+		file.get() != '\n')
+		return false;
+
+	std::ostringstream robotsTxt;
+	robotsTxt << file.rdbuf();
+	entry.rules = Compile(robotsTxt.str(), userAgent);
+	return true;
+}
+
+bool RobotsCache::WriteFile(const std::string& host, const std::string& robotsTxt, const std::int64_t& fetchTime) const
+{
+	std::error_code ec;
+	std::filesystem::create_directories(directory, ec);
+
+	std::ofstream file(GetFileName(host), std::ios::binary | std::ios::trunc);
+	if (!file.good())
+		return false;
+
+	file << fileHeader << '\n' << fetchTime << '\n';
+	file.write(robotsTxt.data(), robotsTxt.length());
+	return file.good();
+}
+
+std::string RobotsCache::GetFileName(const std::string& host) const
+{
+	// Host may include a port
+	std::string name(host);
+	for (auto& c : name)
+	{
+		if (!std::isalnum(static_cast<unsigned char>(c)) && c != '.' && c != '-')
+			c = '_';
+	}
+
+	return (std::filesystem::path(directory) / (name + fileExtension)).string();
+}
+
+std::int64_t RobotsCache::Now()
+{
+	return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+std::shared_ptr<const RobotsRules> RobotsCache::Compile(const std::string& robotsTxt, const std::string& userAgent)
+{
+	auto rules(std::make_shared<RobotsRules>());
+	rules->Parse(robotsTxt, userAgent);
+	return rules;
+}
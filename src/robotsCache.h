@@ -0,0 +1,64 @@
+// File:  robotsCache.h
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Compiled robots.txt rules for each host, kept in memory and saved to disk so robots.txt
+//        is only downloaded again once the saved copy expires.
+
+#ifndef ROBOTS_CACHE_H_
+#define ROBOTS_CACHE_H_
+
+// Local headers
+#include "robotsRules.h"
+
+// Standard C++ headers
+#include <string>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+
+// Local forward declarations
+class HTMLRetriever;
+
+class RobotsCache
+{
+public:
+	RobotsCache(const std::string& directory, const std::chrono::seconds& timeToLive);
+
+	// Rules for the URL's host (compiled for the retriever's user agent), downloading robots.txt if we don't have a
+	// current copy.  If there is no robots.txt (a 4xx response), everything is allowed.  If it can't be retrieved
+	// (a 5xx response or no response), everything is allowed with a conservative crawl delay.  Either way, nothing
+	// is saved, and we try again next time.
+	std::shared_ptr<const RobotsRules> GetRules(HTMLRetriever& retriever, const std::string& url);
+
+	static bool IsRobotsTxtURL(const std::string& url);
+	static std::string GetRobotsTxtURL(const std::string& url);
+
+private:
+	static const std::string fileHeader;
+	static const std::string fileExtension;
+	static const std::chrono::steady_clock::duration fallbackCrawlDelay;
+
+	const std::string directory;
+	const std::chrono::seconds timeToLive;
+
+	struct Entry
+	{
+		std::shared_ptr<const RobotsRules> rules;
+		std::int64_t fetchTime;// [sec since epoch]
+	};
+
+	std::map<std::string, Entry> hosts;
+	std::mutex mutex;
+
+	bool IsFresh(const Entry& entry) const;
+	bool ReadFile(const std::string& host, const std::string& userAgent, Entry& entry) const;
+	bool WriteFile(const std::string& host, const std::string& robotsTxt, const std::int64_t& fetchTime) const;
+	std::string GetFileName(const std::string& host) const;
+
+	static std::int64_t Now();
+	static std::shared_ptr<const RobotsRules> Compile(const std::string& robotsTxt, const std::string& userAgent);
+};
+
+#endif// ROBOTS_CACHE_H_
@@ -0,0 +1,252 @@
+// File:  robotsRules.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  The rules from a robots.txt file which apply to one user agent, compiled into a path trie
+//        so each URL can be checked in time proportional to the length of its path.
+
+// Local headers
+#include "robotsRules.h"
+
+// Standard C++ headers
+#include <sstream>
+#include <algorithm>
+#include <cctype>
+
+void RobotsRules::Parse(const std::string& robotsTxt, const std::string& userAgent)
+{
+	struct Group
+	{
+		std::vector<std::string> userAgents;
+		std::vector<std::pair<std::string, bool>> rules;// Pattern and allow
+		std::chrono::steady_clock::duration crawlDelay = std::chrono::steady_clock::duration(0);
+	};
+
+	// Consecutive User-agent lines share the rules which follow them
+	std::vector<Group> groups;
+	bool lastLineWasRule(true);
+	std::string line;
+	std::istringstream ss(robotsTxt);
+	while (std::getline(ss, line))
+	{
+		const auto comment(line.find('#'));
+		if (comment != std::string::npos)
+			line.erase(comment);
+
+		const auto colon(line.find(':'));
+		if (colon == std::string::npos)
+			continue;
+
+		const std::string key(ToLower(Trim(line.substr(0, colon))));
+		const std::string value(Trim(line.substr(colon + 1)));
+		if (key == "user-agent")
+		{
+			if (lastLineWasRule)
+				groups.push_back(Group());
+			groups.back().userAgents.push_back(value);
+			lastLineWasRule = false;
+		}
+		else if (IsRuleLine(key))
+		{
+			lastLineWasRule = true;
+			if (groups.empty())
+				continue;// Rules which precede any User-agent line don't apply to anyone
+
+			if (key == "crawl-delay")
+				groups.back().crawlDelay = std::max(groups.back().crawlDelay, ParseCrawlDelay(value));
+			else if (!value.empty() && (value.front() == '/' || value.front() == '*'))// Empty Disallow means allow everything
+				groups.back().rules.push_back(std::make_pair(value, key == "allow"));
+		}
+	}
+
+	// Groups naming us replace the '*' groups rather than adding to them
+	auto groupMatches([&userAgent](const Group& group, const bool& wildcard)
+	{
+		return std::any_of(group.userAgents.begin(), group.userAgents.end(), [&userAgent, &wildcard](const std::string& agent)
+		{
+			return wildcard ? agent == "*" : UserAgentMatches(agent, userAgent);
+		});
+	});
+
+	const bool haveSpecificGroup(std::any_of(groups.begin(), groups.end(), [&groupMatches](const Group& group)
+	{
+		return groupMatches(group, false);
+	}));
+
+	nodes.assign(1, Node());
+	crawlDelay = std::chrono::steady_clock::duration(0);
+	for (const auto& group : groups)
+	{
+		if (!groupMatches(group, !haveSpecificGroup))
+			continue;
+
+		crawlDelay = std::max(crawlDelay, group.crawlDelay);
+		for (const auto& rule : group.rules)
+			AddRule(rule.first, rule.second);
+	}
+}
+
+bool RobotsRules::IsRuleLine(const std::string& key)
+{
+	return key == "allow" || key == "disallow" || key == "crawl-delay";
+}
+
+bool RobotsRules::UserAgentMatches(const std::string& groupAgent, const std::string& userAgent)
+{
+	// Crawlers are identified by the product token (e.g. "eBird" from "eBird Compiler/2.0"), but accept the full string, too
+	const std::string agent(ToLower(groupAgent.substr(0, groupAgent.find('/'))));
+	const std::string ours(ToLower(userAgent.substr(0, userAgent.find('/'))));
+	return !agent.empty() && (agent == ours || agent == ours.substr(0, ours.find(' ')));
+}
+
+void RobotsRules::AddRule(const std::string& pattern, const bool& allow)
+{
+	const bool exact(pattern.back() == '$');
+	const std::string::size_type end(exact ? pattern.length() - 1 : pattern.length());
+
+	unsigned int node(0);
+	for (std::string::size_type i = 0; i < end; ++i)
+	{
+		if (pattern[i] == '*')
+		{
+			if (nodes[node].isWildcard)
+				continue;// "**" is the same as "*"
+
+			if (nodes[node].wildcardChild == 0)
+			{
+				nodes[node].wildcardChild = static_cast<unsigned int>(nodes.size());
+				nodes.push_back(Node());
+				nodes.back().isWildcard = true;
+			}
+			node = nodes[node].wildcardChild;
+		}
+		else
+		{
+			unsigned int child(GetChild(node, pattern[i]));
+			if (child == 0)
+			{
+				child = static_cast<unsigned int>(nodes.size());
+				nodes[node].children.push_back(std::make_pair(pattern[i], child));
+				nodes.push_back(Node());
+			}
+			node = child;
+		}
+	}
+
+	Verdict candidate;
+	candidate.isSet = true;
+	candidate.allow = allow;
+	candidate.patternLength = pattern.length();
+	Apply(candidate, exact ? nodes[node].exactMatch : nodes[node].prefixMatch);
+}
+
+unsigned int RobotsRules::GetChild(const unsigned int& node, const char& c) const
+{
+	for (const auto& child : nodes[node].children)
+	{
+		if (child.first == c)
+			return child.second;
+	}
+
+	return 0;
+}
+
+void RobotsRules::Apply(const Verdict& candidate, Verdict& best)
+{
+	if (!candidate.isSet)
+		return;
+
+	if (!best.isSet || candidate.patternLength > best.patternLength ||
+		(candidate.patternLength == best.patternLength && candidate.allow))
+		best = candidate;
+}
+
+// Adds the node along with the wildcard which may follow it (matching zero characters)
+void RobotsRules::AddState(const std::vector<Node>& nodes, const unsigned int& node, std::vector<unsigned int>& states)
+{
+	if (std::find(states.begin(), states.end(), node) == states.end())
+		states.push_back(node);
+
+	const unsigned int wildcard(nodes[node].wildcardChild);
+	if (wildcard != 0 && std::find(states.begin(), states.end(), wildcard) == states.end())
+		states.push_back(wildcard);
+}
+
+bool RobotsRules::IsAllowed(const std::string& url) const
+{
+	const std::string path(GetPath(url));
+	if (path == "/robots.txt")
+		return true;
+
+	// Walk the trie with every pattern at once.  The active states are bounded by the number of wildcards
+	// in the rules, so for the usual handful of patterns this is linear in the path length.
+	Verdict best;
+	std::vector<unsigned int> states;
+	std::vector<unsigned int> nextStates;
+	AddState(nodes, 0, states);
+	for (const auto& c : path)
+	{
+		nextStates.clear();
+		for (const auto& state : states)
+		{
+			Apply(nodes[state].prefixMatch, best);
+			if (nodes[state].isWildcard)
+				AddState(nodes, state, nextStates);
+
+			const unsigned int child(GetChild(state, c));
+			if (child != 0)
+				AddState(nodes, child, nextStates);
+		}
+
+		states.swap(nextStates);
+		if (states.empty())
+			break;
+	}
+
+	for (const auto& state : states)
+	{
+		Apply(nodes[state].prefixMatch, best);
+		Apply(nodes[state].exactMatch, best);
+	}
+
+	return !best.isSet || best.allow;
+}
+
+std::string RobotsRules::GetPath(const std::string& url)
+{
+	std::string::size_type start(url.find("://"));
+	start = url.find_first_of("/?#", start == std::string::npos ? 0 : start + 3);
+	if (start == std::string::npos)
+		return "/";
+
+	std::string path(url.substr(start, url.find('#', start) - start));
+	if (path.empty() || path.front() != '/')
+		path.insert(0, "/");
+	return path;
+}
+
+std::string RobotsRules::ToLower(std::string s)
+{
+	std::transform(s.begin(), s.end(), s.begin(), [](const unsigned char& c)
+	{
+		return static_cast<char>(std::tolower(c));
+	});
+	return s;
+}
+
+std::string RobotsRules::Trim(const std::string& s)
+{
+	const auto start(s.find_first_not_of(" \t\r\n"));
+	if (start == std::string::npos)
+		return std::string();
+	return s.substr(start, s.find_last_not_of(" \t\r\n") - start + 1);
+}
+
+std::chrono::steady_clock::duration RobotsRules::ParseCrawlDelay(const std::string& value)
+{
+	std::istringstream ss(value);
+	double seconds;
+	if ((ss >> seconds).fail() || !(seconds > 0.0))
+		return std::chrono::steady_clock::duration(0);
+
+	return std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(std::min(seconds, 3600.0)));
+}
@@ -0,0 +1,65 @@
+// File:  robotsRules.h
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  The rules from a robots.txt file which apply to one user agent, compiled into a path trie
+//        so each URL can be checked in time proportional to the length of its path.
+
+#ifndef ROBOTS_RULES_H_
+#define ROBOTS_RULES_H_
+
+// Standard C++ headers
+#include <string>
+#include <vector>
+#include <chrono>
+#include <utility>
+
+class RobotsRules
+{
+public:
+	// With nothing parsed, everything is allowed
+	void Parse(const std::string& robotsTxt, const std::string& userAgent);
+
+	// Longest matching pattern wins, and Allow wins a tie with Disallow (RFC 9309)
+	bool IsAllowed(const std::string& url) const;
+
+	std::chrono::steady_clock::duration GetCrawlDelay() const { return crawlDelay; }
+	void SetCrawlDelay(const std::chrono::steady_clock::duration& delay) { crawlDelay = delay; }
+
+	// Path and query of the URL, which is what patterns are matched against
+	static std::string GetPath(const std::string& url);
+
+private:
+	std::chrono::steady_clock::duration crawlDelay = std::chrono::steady_clock::duration(0);
+
+	struct Verdict
+	{
+		bool isSet = false;
+		bool allow = true;
+		std::string::size_type patternLength = 0;
+	};
+
+	struct Node
+	{
+		std::vector<std::pair<char, unsigned int>> children;
+		unsigned int wildcardChild = 0;// Zero if none (the root is never a child)
+		bool isWildcard = false;// Matches any sequence of characters, so it stays active as we advance
+
+		Verdict prefixMatch;// Pattern ends here - any path continuing from this node matches
+		Verdict exactMatch;// Pattern ends here with '$' - only a path ending at this node matches
+	};
+
+	std::vector<Node> nodes = std::vector<Node>(1);// Root is nodes[0]
+
+	void AddRule(const std::string& pattern, const bool& allow);
+	unsigned int GetChild(const unsigned int& node, const char& c) const;// Zero if none
+	static void Apply(const Verdict& candidate, Verdict& best);
+	static void AddState(const std::vector<Node>& nodes, const unsigned int& node, std::vector<unsigned int>& states);
+
+	static bool IsRuleLine(const std::string& key);
+	static bool UserAgentMatches(const std::string& groupAgent, const std::string& userAgent);
+	static std::string ToLower(std::string s);
+	static std::string Trim(const std::string& s);
+	static std::chrono::steady_clock::duration ParseCrawlDelay(const std::string& value);
+};
+
+#endif// ROBOTS_RULES_H_
@@ -0,0 +1,96 @@
+// File:  sharedTaxonomy.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Thread-safe owner of a parsed taxonomy, which is loaded in the background
+//        and reloaded only when a taxonomy file changes.
+
+// Local headers
+#include "sharedTaxonomy.h"
+#include "taxonomyOrder.h"
+#include "taxonomyRegistry.h"
+#include "instrumentation.h"
+
+// Standard C++ headers
+#include <filesystem>
+
+#if defined(_MSC_VER) && _MSC_VER < 1914
+#define filesystem experimental::filesystem
+#endif
+
+SharedTaxonomy::SharedTaxonomy(const std::string& userAgent, const std::string& fileName, const std::vector<std::string>& previousFileNames)
+	: userAgent(userAgent), fileNames([&fileName, &previousFileNames]()
+	{
+		std::vector<std::string> names({ fileName });
+		names.insert(names.end(), previousFileNames.begin(), previousFileNames.end());
+		return names;
+	}())
+{
+}
+
+void SharedTaxonomy::BeginLoad()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (NeedsLoad())
+		loadResult = std::async(std::launch::async, &SharedTaxonomy::Load, this).share();
+}
+
+std::shared_ptr<const TaxonomyOrder> SharedTaxonomy::Get(std::string& errorString)
+{
+	std::shared_future<LoadResult> result;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (NeedsLoad())
+			loadResult = std::async(std::launch::async, &SharedTaxonomy::Load, this).share();
+		result = loadResult;
+	}
+	
+	// Callers keep their own reference, so a reload triggered by another thread won't pull the taxonomy out from under them
+	const LoadResult& r(result.get());
+	if (!r.taxonomy)
+		errorString = r.errorString;
+	return r.taxonomy;
+}
+
+bool SharedTaxonomy::NeedsLoad() const
+{
+	if (!loadResult.valid())
+		return true;
+		
+	// Let in-progress loads finish rather than starting a second one
+	if (loadResult.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		return false;
+		
+	const LoadResult& r(loadResult.get());
+	if (!r.taxonomy)
+		return true;// Try again after failures
+		
+	return GetModifiedTimes() != r.modifiedTimes;
+}
+
+SharedTaxonomy::LoadResult SharedTaxonomy::Load() const
+{
+	Instrumentation::Span span("taxonomy load");
+	LoadResult result;
+	auto registry(std::make_shared<TaxonomyRegistry>(userAgent));
+	if (registry->Load(fileNames))
+		result.taxonomy = std::shared_ptr<const TaxonomyOrder>(registry, &registry->GetCurrent());// Keeps the earlier versions alive, too
+	else
+		result.errorString = registry->GetErrorString();
+		
+	// Taken after parsing, since Parse() may have downloaded the file
+	result.modifiedTimes = GetModifiedTimes();
+	return result;
+}
+
+std::vector<std::int64_t> SharedTaxonomy::GetModifiedTimes() const
+{
+	std::vector<std::int64_t> modifiedTimes;
+	for (const auto& f : fileNames)
+	{
+		std::error_code ec;
+		const auto modifiedTime(std::filesystem::last_write_time(f, ec));
+		modifiedTimes.push_back(ec ? 0 : static_cast<std::int64_t>(modifiedTime.time_since_epoch().count()));
+	}
+	
+	return modifiedTimes;
+}
@@ -0,0 +1,52 @@
+// File:  sharedTaxonomy.h
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Thread-safe owner of a parsed taxonomy, which is loaded in the background
+//        and reloaded only when a taxonomy file changes.
+
+#ifndef SHARED_TAXONOMY_H_
+#define SHARED_TAXONOMY_H_
+
+// Standard C++ headers
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <future>
+#include <cstdint>
+
+// Local forward declarations
+class TaxonomyOrder;
+
+class SharedTaxonomy
+{
+public:
+	// Names from the previous versions (most recent first) are also recognized, and resolve to their current taxa
+	SharedTaxonomy(const std::string& userAgent, const std::string& fileName, const std::vector<std::string>& previousFileNames = std::vector<std::string>());
+	
+	// Starts loading in the background (if not already loaded or loading) and returns immediately
+	void BeginLoad();
+	
+	// Waits for any in-progress load to complete.  Returns nullptr and sets errorString on failure.
+	std::shared_ptr<const TaxonomyOrder> Get(std::string& errorString);
+
+private:
+	const std::string userAgent;
+	const std::vector<std::string> fileNames;// Current version first
+	
+	struct LoadResult
+	{
+		std::shared_ptr<const TaxonomyOrder> taxonomy;
+		std::string errorString;
+		std::vector<std::int64_t> modifiedTimes;
+	};
+	
+	std::mutex mutex;
+	std::shared_future<LoadResult> loadResult;
+	
+	bool NeedsLoad() const;// Caller must hold mutex
+	LoadResult Load() const;
+	std::vector<std::int64_t> GetModifiedTimes() const;
+};
+
+#endif// SHARED_TAXONOMY_H_
@@ -0,0 +1,327 @@
+// File:  speciesNameIndex.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Index for finding species whose names on a page don't exactly match the taxonomy,
+//        first by a normalized form of the name, then by the closest name sharing the most
+//        trigrams, within a small edit distance.
+
+// Local headers
+#include "speciesNameIndex.h"
+
+// Standard C++ headers
+#include <algorithm>
+#include <cctype>
+
+const std::size_t SpeciesNameIndex::minFuzzyLength(6);
+const double SpeciesNameIndex::minSimilarity(0.5);
+const std::size_t SpeciesNameIndex::maxCandidates(8);
+
+SpeciesNameIndex::SpeciesNameIndex(const std::vector<std::pair<std::string_view, unsigned int>>& names)
+{
+	entries.reserve(names.size());
+	for (const auto& n : names)
+		entries.push_back(Entry{ Normalize(n.first), n.second, 0 });
+
+	// Entries don't move after this, so the lookup can refer to their keys
+	std::vector<std::pair<std::uint32_t, std::uint32_t>> trigramEntries;// (trigram, entry)
+	for (std::uint32_t i = 0; i < entries.size(); ++i)
+	{
+		if (!entryLookup.emplace(entries[i].key, i).second)
+			continue;
+
+		const auto entryTrigrams(GetTrigrams(entries[i].key));
+		entries[i].trigramCount = static_cast<std::uint32_t>(entryTrigrams.size());
+		for (const auto& t : entryTrigrams)
+			trigramEntries.push_back(std::make_pair(t, i));
+	}
+
+	std::sort(trigramEntries.begin(), trigramEntries.end());
+	postings.reserve(trigramEntries.size());
+	for (const auto& te : trigramEntries)
+	{
+		if (trigrams.empty() || trigrams.back() != te.first)
+		{
+			trigrams.push_back(te.first);
+			postingStarts.push_back(static_cast<std::uint32_t>(postings.size()));
+		}
+
+		postings.push_back(te.second);
+	}
+
+	postingStarts.push_back(static_cast<std::uint32_t>(postings.size()));
+}
+
+bool SpeciesNameIndex::Find(const std::string_view& name, unsigned int& index) const
+{
+	const std::string key(Normalize(name));
+	const auto it(entryLookup.find(key));
+	if (it != entryLookup.end())
+	{
+		index = entries[it->second].index;
+		return true;
+	}
+
+	return FindClosest(key, index);
+}
+
+// Names sharing the most trigrams with the key are checked for edit distance, and the closest is accepted if it's
+// within a few edits and no name of another taxon is as close
+bool SpeciesNameIndex::FindClosest(const std::string& key, unsigned int& index) const
+{
+	if (key.length() < minFuzzyLength)
+		return false;
+
+	const auto keyTrigrams(GetTrigrams(key));
+	std::vector<std::uint16_t> sharedCounts(entries.size(), 0);
+	std::vector<std::uint32_t> touched;
+	for (const auto& t : keyTrigrams)
+	{
+		const auto it(std::lower_bound(trigrams.begin(), trigrams.end(), t));
+		if (it == trigrams.end() || *it != t)
+			continue;
+
+		const auto trigramIndex(it - trigrams.begin());
+		for (auto p = postingStarts[trigramIndex]; p < postingStarts[trigramIndex + 1]; ++p)
+		{
+			if (sharedCounts[postings[p]]++ == 0)
+				touched.push_back(postings[p]);
+		}
+	}
+
+	std::vector<std::pair<double, std::uint32_t>> candidates;// (similarity, entry)
+	for (const auto& e : touched)
+	{
+		const double similarity(2.0 * sharedCounts[e] / (keyTrigrams.size() + entries[e].trigramCount));
+		if (similarity >= minSimilarity)
+			candidates.push_back(std::make_pair(similarity, e));
+	}
+
+	const std::size_t candidateCount(std::min(candidates.size(), maxCandidates));
+	std::partial_sort(candidates.begin(), candidates.begin() + candidateCount, candidates.end(),
+		[](const std::pair<double, std::uint32_t>& a, const std::pair<double, std::uint32_t>& b)
+	{
+		return a.first > b.first;
+	});
+
+	const std::size_t maxEdits(GetMaxEdits(key.length()));
+	std::size_t bestDistance(maxEdits + 1);
+	bool ambiguous(false);
+	for (std::size_t i = 0; i < candidateCount; ++i)
+	{
+		const Entry& entry(entries[candidates[i].second]);
+		const std::size_t distance(GetEditDistance(key, entry.key, maxEdits));
+		if (distance < bestDistance)
+		{
+			bestDistance = distance;
+			index = entry.index;
+			ambiguous = false;
+		}
+		else if (distance == bestDistance && entry.index != index)
+			ambiguous = true;
+	}
+
+	return bestDistance <= maxEdits && !ambiguous;
+}
+
+std::vector<std::uint32_t> SpeciesNameIndex::GetTrigrams(const std::string& key)
+{
+	// Padded so the start and end of the name count, too
+	const std::string padded("  " + key + " ");
+	std::vector<std::uint32_t> keyTrigrams;
+	for (std::string::size_type i = 0; i + 2 < padded.length(); ++i)
+		keyTrigrams.push_back(static_cast<std::uint32_t>(static_cast<unsigned char>(padded[i])) << 16 |
+			static_cast<std::uint32_t>(static_cast<unsigned char>(padded[i + 1])) << 8 |
+			static_cast<unsigned char>(padded[i + 2]));
+
+	std::sort(keyTrigrams.begin(), keyTrigrams.end());
+	keyTrigrams.erase(std::unique(keyTrigrams.begin(), keyTrigrams.end()), keyTrigrams.end());
+	return keyTrigrams;
+}
+
+std::size_t SpeciesNameIndex::GetMaxEdits(const std::size_t& length)
+{
+	// Many names differ from another by a single word, so only allow for typos
+	if (length < 16)
+		return 1;
+	return 2;
+}
+
+std::size_t SpeciesNameIndex::GetEditDistance(const std::string_view& a, const std::string_view& b, const std::size_t& limit)
+{
+	if ((a.length() > b.length() ? a.length() - b.length() : b.length() - a.length()) > limit)
+		return limit + 1;
+
+	// Levenshtein distance with a single row, stopping once every entry in a row exceeds the limit
+	std::vector<std::size_t> row(b.length() + 1);
+	for (std::size_t j = 0; j <= b.length(); ++j)
+		row[j] = j;
+
+	for (std::size_t i = 1; i <= a.length(); ++i)
+	{
+		std::size_t diagonal(row[0]);
+		row[0] = i;
+		std::size_t rowMinimum(row[0]);
+		for (std::size_t j = 1; j <= b.length(); ++j)
+		{
+			const std::size_t above(row[j]);
+			row[j] = std::min({ row[j] + 1, row[j - 1] + 1, diagonal + (a[i - 1] == b[j - 1] ? 0 : 1) });
+			diagonal = above;
+			rowMinimum = std::min(rowMinimum, row[j]);
+		}
+
+		if (rowMinimum > limit)
+			return limit + 1;
+	}
+
+	return std::min(row.back(), limit + 1);
+}
+
+std::string SpeciesNameIndex::Normalize(const std::string_view& name)
+{
+	std::string key;
+	bool pendingSpace(false);
+	std::string_view::size_type position(0);
+	while (position < name.length())
+	{
+		std::uint32_t codePoint;
+		if (!DecodeEntity(name, position, codePoint) && !DecodeUTF8(name, position, codePoint))
+			codePoint = static_cast<unsigned char>(name[position++]);// Not valid UTF-8 - keep the byte as it is
+
+		if (codePoint == 0x2018 || codePoint == 0x2019 || codePoint == 0x02BC || codePoint == 0x00B4 || codePoint == '`')
+			codePoint = '\'';
+		else if (codePoint == 0x2010 || codePoint == 0x2011 || codePoint == 0x2013)
+			codePoint = '-';
+		else if (codePoint == 0x00A0 || (codePoint < 0x80 && std::isspace(static_cast<int>(codePoint))))
+		{
+			pendingSpace = !key.empty();
+			continue;
+		}
+
+		if (pendingSpace)
+			key.push_back(' ');
+		pendingSpace = false;
+
+		if (codePoint < 0x80)
+			key.push_back(static_cast<char>(std::tolower(static_cast<int>(codePoint))));
+		else
+			AppendUTF8(codePoint, key);
+	}
+
+	return key;
+}
+
+// Numeric references, and the named entities likely to appear in a name
+bool SpeciesNameIndex::DecodeEntity(const std::string_view& name, std::string_view::size_type& position, std::uint32_t& codePoint)
+{
+	if (name[position] != '&')
+		return false;
+
+	const auto end(name.find(';', position));
+	if (end == std::string_view::npos || end - position > 10)
+		return false;
+
+	const std::string_view entity(name.substr(position + 1, end - position - 1));
+	if (entity.length() > 1 && entity.front() == '#')
+	{
+		const bool hex(entity[1] == 'x' || entity[1] == 'X');
+		const std::string_view digits(entity.substr(hex ? 2 : 1));
+		if (digits.empty())
+			return false;
+
+		codePoint = 0;
+		for (const auto& c : digits)
+		{
+			if (!std::isxdigit(static_cast<unsigned char>(c)) || (!hex && !std::isdigit(static_cast<unsigned char>(c))))
+				return false;
+			codePoint = codePoint * (hex ? 16 : 10) + (std::isdigit(static_cast<unsigned char>(c)) ? c - '0' : std::tolower(c) - 'a' + 10);
+		}
+	}
+	else if (entity == "amp")
+		codePoint = '&';
+	else if (entity == "apos")
+		codePoint = '\'';
+	else if (entity == "quot")
+		codePoint = '"';
+	else if (entity == "lt")
+		codePoint = '<';
+	else if (entity == "gt")
+		codePoint = '>';
+	else if (entity == "nbsp")
+		codePoint = 0x00A0;
+	else if (entity == "rsquo" || entity == "lsquo")
+		codePoint = 0x2019;
+	else if (entity == "ndash")
+		codePoint = 0x2013;
+	else
+		return false;
+
+	position = end + 1;
+	return true;
+}
+
+bool SpeciesNameIndex::DecodeUTF8(const std::string_view& name, std::string_view::size_type& position, std::uint32_t& codePoint)
+{
+	const unsigned char lead(static_cast<unsigned char>(name[position]));
+	std::size_t length;
+	if (lead < 0x80)
+	{
+		codePoint = lead;
+		++position;
+		return true;
+	}
+	else if ((lead & 0xE0) == 0xC0)
+	{
+		length = 2;
+		codePoint = lead & 0x1F;
+	}
+	else if ((lead & 0xF0) == 0xE0)
+	{
+		length = 3;
+		codePoint = lead & 0x0F;
+	}
+	else if ((lead & 0xF8) == 0xF0)
+	{
+		length = 4;
+		codePoint = lead & 0x07;
+	}
+	else
+		return false;
+
+	if (position + length > name.length())
+		return false;
+
+	for (std::size_t i = 1; i < length; ++i)
+	{
+		const unsigned char c(static_cast<unsigned char>(name[position + i]));
+		if ((c & 0xC0) != 0x80)
+			return false;
+		codePoint = (codePoint << 6) | (c & 0x3F);
+	}
+
+	position += length;
+	return true;
+}
+
+void SpeciesNameIndex::AppendUTF8(const std::uint32_t& codePoint, std::string& s)
+{
+	if (codePoint < 0x80)
+		s.push_back(static_cast<char>(codePoint));
+	else if (codePoint < 0x800)
+	{
+		s.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+		s.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+	}
+	else if (codePoint < 0x10000)
+	{
+		s.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+		s.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+		s.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+	}
+	else
+	{
+		s.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+		s.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+		s.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+		s.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+	}
+}
@@ -0,0 +1,62 @@
+// File:  speciesNameIndex.h
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Index for finding species whose names on a page don't exactly match the taxonomy,
+//        first by a normalized form of the name, then by the closest name sharing the most
+//        trigrams, within a small edit distance.
+
+#ifndef SPECIES_NAME_INDEX_H_
+#define SPECIES_NAME_INDEX_H_
+
+// Standard C++ headers
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <utility>
+#include <cstdint>
+
+class SpeciesNameIndex
+{
+public:
+	// Pairs of name and taxon index; where two names normalize to the same key, the first is kept
+	explicit SpeciesNameIndex(const std::vector<std::pair<std::string_view, unsigned int>>& names);
+
+	bool Find(const std::string_view& name, unsigned int& index) const;
+
+	// HTML entities decoded, curly apostrophes and dashes replaced by their ASCII equivalents, ASCII letters lowercased,
+	// and whitespace trimmed and collapsed to single spaces
+	static std::string Normalize(const std::string_view& name);
+
+private:
+	static const std::size_t minFuzzyLength;// Shorter names must match once normalized
+	static const double minSimilarity;// Dice coefficient of trigram sets, for a name to be considered
+	static const std::size_t maxCandidates;// Number of the most similar names to check edit distance for
+
+	struct Entry
+	{
+		std::string key;
+		unsigned int index;
+		std::uint32_t trigramCount;
+	};
+
+	std::vector<Entry> entries;
+	std::unordered_map<std::string_view, std::uint32_t> entryLookup;// Keys refer to the entries
+
+	// Sorted distinct trigrams, each with a range of postings (entry indices)
+	std::vector<std::uint32_t> trigrams;
+	std::vector<std::uint32_t> postingStarts;// One more than there are trigrams
+	std::vector<std::uint32_t> postings;
+
+	bool FindClosest(const std::string& key, unsigned int& index) const;
+
+	static std::vector<std::uint32_t> GetTrigrams(const std::string& key);// Sorted, without duplicates
+	static std::size_t GetMaxEdits(const std::size_t& length);
+	static std::size_t GetEditDistance(const std::string_view& a, const std::string_view& b, const std::size_t& limit);// limit + 1 if more than limit
+
+	static bool DecodeEntity(const std::string_view& name, std::string_view::size_type& position, std::uint32_t& codePoint);
+	static bool DecodeUTF8(const std::string_view& name, std::string_view::size_type& position, std::uint32_t& codePoint);
+	static void AppendUTF8(const std::uint32_t& codePoint, std::string& s);
+};
+
+#endif// SPECIES_NAME_INDEX_H_
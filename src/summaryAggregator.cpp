@@ -0,0 +1,206 @@
+// File:  summaryAggregator.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Running totals over a set of checklists.  Each checklist's contribution is kept
+//        so it can be removed exactly, allowing summaries to be updated incrementally.
+
+// Local headers
+#include "summaryAggregator.h"
+#include "taxonomyOrder.h"
+
+// Standard C++ headers
+#include <algorithm>
+#include <sstream>
+#include <cassert>
+#include <cmath>
+
+void SummaryAggregator::Add(const std::string& key, const ChecklistInfo& info)
+{
+	AddChecklist(key, info);
+}
+
+void SummaryAggregator::Add(const std::string& key, const ChecklistView& view)
+{
+	AddChecklist(key, view);
+}
+
+template <typename Checklist>
+void SummaryAggregator::AddChecklist(const std::string& key, const Checklist& checklist)
+{
+	Remove(key);
+	
+	Contribution c;
+	c.identifier.assign(checklist.identifier);
+	c.location.assign(checklist.location);
+	c.dateCode = GetDateCode(checklist.day, checklist.month, checklist.year);
+	c.distance = ToFixedPoint(checklist.distance);
+	c.time = ToFixedPoint(checklist.duration);
+	c.anonymous = false;
+	
+	// Count each birder once per checklist, even if the page lists them twice
+	for (const auto& b : checklist.birders)
+	{
+		if (std::find(c.birders.begin(), c.birders.end(), b) == c.birders.end())
+			c.birders.emplace_back(b);
+		if (b == "Anonymous eBirder")
+			c.anonymous = true;
+	}
+	
+	c.species.reserve(checklist.species.size());
+	for (const auto& s : checklist.species)
+	{
+		assert(s.taxonIndex < species.size());
+		c.species.push_back(SpeciesCount{ s.taxonIndex, s.count });
+		SpeciesTotal& total(species[s.taxonIndex]);
+		++total.checklistCount;
+		total.count += s.count;
+	}
+	
+	totalDistance += c.distance;
+	totalTime += c.time;
+	checklistsByDateCode[c.dateCode].insert(c.identifier);
+	for (const auto& b : c.birders)
+		++participants[b];
+	if (c.anonymous)
+		++anonymousChecklistCount;
+	++locations[c.location];
+	
+	contributions[key] = std::move(c);
+}
+
+bool SummaryAggregator::Remove(const std::string& key)
+{
+	const auto it(contributions.find(key));
+	if (it == contributions.end())
+		return false;
+		
+	const Contribution& c(it->second);
+	totalDistance -= c.distance;
+	totalTime -= c.time;
+	
+	const auto dateIt(checklistsByDateCode.find(c.dateCode));
+	assert(dateIt != checklistsByDateCode.end());
+	dateIt->second.erase(c.identifier);
+	if (dateIt->second.empty())
+		checklistsByDateCode.erase(dateIt);
+		
+	for (const auto& b : c.birders)
+		Release(participants, b);
+		
+	if (c.anonymous)
+		--anonymousChecklistCount;
+		
+	Release(locations, c.location);
+	
+	for (const auto& s : c.species)
+	{
+		SpeciesTotal& total(species[s.taxonIndex]);
+		assert(total.checklistCount > 0);
+		total.count -= s.count;
+		--total.checklistCount;
+	}
+	
+	contributions.erase(it);
+	return true;
+}
+
+void SummaryAggregator::Clear()
+{
+	SetTaxonomy(taxonomy);
+}
+
+void SummaryAggregator::SetTaxonomy(std::shared_ptr<const TaxonomyOrder> newTaxonomy)
+{
+	*this = SummaryAggregator();
+	taxonomy = std::move(newTaxonomy);
+	if (taxonomy)
+		species.resize(taxonomy->GetTaxonCount());
+}
+
+std::vector<std::string> SummaryAggregator::GetKeys() const
+{
+	std::vector<std::string> keys;
+	keys.reserve(contributions.size());
+	for (const auto& c : contributions)
+		keys.push_back(c.first);
+	return keys;
+}
+
+std::vector<std::string> SummaryAggregator::GetParticipants() const
+{
+	std::vector<std::string> names;
+	names.reserve(participants.size());
+	for (const auto& p : participants)
+		names.push_back(p.first);
+	return names;
+}
+
+std::vector<SpeciesInfo> SummaryAggregator::GetSpecies() const
+{
+	std::vector<SpeciesInfo> list;
+	if (!taxonomy)
+		return list;
+		
+	// Fold subspecies and domestic types into their parents, then walk the taxa in order so no sort is needed
+	std::vector<SpeciesTotal> reported(species.size());
+	for (unsigned int i = 0; i < species.size(); ++i)
+	{
+		if (species[i].checklistCount == 0)
+			continue;
+			
+		SpeciesTotal& total(reported[taxonomy->GetReportAsIndex(i)]);
+		total.count += species[i].count;
+		total.checklistCount += species[i].checklistCount;
+	}
+	
+	for (const auto& i : taxonomy->GetIndicesInTaxonomicOrder())
+	{
+		if (reported[i].checklistCount == 0)
+			continue;
+			
+		SpeciesInfo info;
+		info.name.assign(taxonomy->GetCommonName(i));
+		info.count = reported[i].count;
+		info.taxonomicOrder = taxonomy->GetTaxonomicSequence(i);
+		info.taxonIndex = i;
+		list.push_back(info);
+	}
+	
+	return list;
+}
+
+unsigned int SummaryAggregator::GetDateCode(const unsigned int& day, const unsigned int& month, const unsigned int& year)
+{
+	assert(month > 0 && month <= 12);
+	assert(day > 0 && day <= 31);
+	assert(year > 1700);
+	return (year - 1700) + month * 1000 + day * 100000;
+}
+
+std::string SummaryAggregator::GetDateFromCode(const unsigned int& code)
+{
+	const unsigned int day(code / 100000);
+	const unsigned int month((code - day * 100000) / 1000);
+	const unsigned int year(code - day * 100000 - month * 1000 + 1700);
+	std::ostringstream ss;
+	ss << month << '/' << day << '/' << year;
+	return ss.str();
+}
+
+std::int64_t SummaryAggregator::ToFixedPoint(const double& value)
+{
+	return std::llround(value * 1.0e6);
+}
+
+double SummaryAggregator::FromFixedPoint(const std::int64_t& value)
+{
+	return value * 1.0e-6;
+}
+
+void SummaryAggregator::Release(std::map<std::string, unsigned int>& counts, const std::string& key)
+{
+	const auto it(counts.find(key));
+	assert(it != counts.end() && it->second > 0);
+	if (--it->second == 0)
+		counts.erase(it);
+}
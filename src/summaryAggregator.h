@@ -0,0 +1,106 @@
+// File:  summaryAggregator.h
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Running totals over a set of checklists.  Each checklist's contribution is kept
+//        so it can be removed exactly, allowing summaries to be updated incrementally.
+
+#ifndef SUMMARY_AGGREGATOR_H_
+#define SUMMARY_AGGREGATOR_H_
+
+// Local headers
+#include "eBirdChecklistParser.h"
+
+// Standard C++ headers
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <memory>
+#include <cstdint>
+
+// Local forward declarations
+class TaxonomyOrder;
+
+class SummaryAggregator
+{
+public:
+	// Replaces any existing checklist with the same key
+	void Add(const std::string& key, const ChecklistInfo& info);
+	void Add(const std::string& key, const ChecklistView& view);
+	bool Remove(const std::string& key);
+	void Clear();
+	
+	// Species are tallied by taxon index, so checklists must have been parsed against this taxonomy.
+	// Changing the taxonomy clears everything.
+	void SetTaxonomy(std::shared_ptr<const TaxonomyOrder> taxonomy);
+	const std::shared_ptr<const TaxonomyOrder>& GetTaxonomy() const { return taxonomy; }
+	
+	bool Contains(const std::string& key) const { return contributions.find(key) != contributions.end(); }
+	std::vector<std::string> GetKeys() const;
+	
+	std::size_t GetChecklistCount() const { return contributions.size(); }
+	std::vector<std::string> GetParticipants() const;
+	std::size_t GetLocationCount() const { return locations.size(); }
+	unsigned int GetAnonymousChecklistCount() const { return anonymousChecklistCount; }
+	double GetTotalDistance() const { return FromFixedPoint(totalDistance); }// [km]
+	double GetTotalTime() const { return FromFixedPoint(totalTime); }// [min]
+	std::vector<SpeciesInfo> GetSpecies() const;// Subspecies are counted as their parent species; in taxonomic order
+	
+	// Values are checklist identifiers
+	const std::map<unsigned int, std::set<std::string>>& GetChecklistsByDateCode() const { return checklistsByDateCode; }
+	
+	static unsigned int GetDateCode(const unsigned int& day, const unsigned int& month, const unsigned int& year);
+	static std::string GetDateFromCode(const unsigned int& code);
+
+private:
+	struct SpeciesCount
+	{
+		unsigned int taxonIndex;
+		unsigned int count;
+	};
+	
+	// Everything a checklist added to the totals, so it can be subtracted again
+	struct Contribution
+	{
+		std::string identifier;
+		std::vector<std::string> birders;// Without duplicates
+		std::string location;
+		bool anonymous;
+		unsigned int dateCode;
+		std::int64_t distance;
+		std::int64_t time;
+		std::vector<SpeciesCount> species;
+	};
+	
+	std::map<std::string, Contribution> contributions;
+	
+	// Values are the number of checklists which reference each key, so we know when to drop entries
+	std::map<std::string, unsigned int> participants;
+	std::map<std::string, unsigned int> locations;
+	
+	std::shared_ptr<const TaxonomyOrder> taxonomy;
+	
+	struct SpeciesTotal
+	{
+		unsigned int count = 0;
+		unsigned int checklistCount = 0;
+	};
+	
+	std::vector<SpeciesTotal> species;// Indexed by taxon index (one entry per taxon)
+	std::map<unsigned int, std::set<std::string>> checklistsByDateCode;
+	unsigned int anonymousChecklistCount = 0;
+	
+	// Sums of floating point values are kept in fixed point so removals exactly undo additions
+	std::int64_t totalDistance = 0;
+	std::int64_t totalTime = 0;
+	
+	template <typename Checklist>
+	void AddChecklist(const std::string& key, const Checklist& checklist);
+	
+	static std::int64_t ToFixedPoint(const double& value);
+	static double FromFixedPoint(const std::int64_t& value);
+	
+	static void Release(std::map<std::string, unsigned int>& counts, const std::string& key);
+};
+
+#endif// SUMMARY_AGGREGATOR_H_
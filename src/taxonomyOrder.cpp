@@ -7,6 +7,7 @@
 
 // Local headers
 #include "taxonomyOrder.h"
+#include "speciesNameIndex.h"
 #include "htmlRetriever.h"
 
 // Standard C++ headers
@@ -14,172 +15,805 @@
 #include <algorithm>
 #include <filesystem>
 #include <cctype>
-#include <iomanip>
+#include <cstring>
+#include <charconv>
+#include <thread>
 
 #if defined(_MSC_VER) && _MSC_VER < 1914
 #define filesystem experimental::filesystem
 #endif
 
 const std::string TaxonomyOrder::taxonomyFileURL("https://www.birds.cornell.edu/clementschecklist/wp-content/uploads/2019/08/eBird_Taxonomy_v2019.csv");
+const std::string TaxonomyOrder::cacheFileExtension(".bin");
+const char TaxonomyOrder::cacheMagic[8] = { 'E', 'B', 'T', 'A', 'X', 'B', 'I', 'N' };
+const std::uint32_t TaxonomyOrder::cacheVersion(3);// Increment whenever the layout of CacheHeader or TaxaInfo (or how the .csv is read) changes
+const std::size_t TaxonomyOrder::minChunkSize(1 << 18);
+const std::uint64_t TaxonomyOrder::initialChecksum(14695981039346656037ull);
+const std::array<TaxonomyOrder::StringReference TaxonomyOrder::TaxaInfo::*, 7> TaxonomyOrder::csvStringFields({ &TaxaInfo::speciesCode,
+	&TaxaInfo::commonName, &TaxaInfo::scientificName, &TaxaInfo::order, &TaxaInfo::family, &TaxaInfo::speciesGroup, &TaxaInfo::reportAs });
+const std::array<TaxonomyOrder::CSVColumn, 9> TaxonomyOrder::csvColumns({
+	CSVColumn{ { "TAXON_ORDER" }, true },
+	CSVColumn{ { "CATEGORY" }, true },
+	CSVColumn{ { "SPECIES_CODE" }, true },
+	CSVColumn{ { "PRIMARY_COM_NAME" }, true },
+	CSVColumn{ { "SCI_NAME" }, true },
+	CSVColumn{ { "ORDER1", "ORDER" }, false },
+	CSVColumn{ { "FAMILY" }, false },
+	CSVColumn{ { "SPECIES_GROUP" }, false },
+	CSVColumn{ { "REPORT_AS" }, true } });
+
+TaxonomyOrder::TaxonomyOrder(const std::string& userAgent) : userAgent(userAgent)
+{
+}
+
+TaxonomyOrder::~TaxonomyOrder() = default;
 
 bool TaxonomyOrder::Parse(const std::string& fileName)
 {
+	Reset();
 	if (!std::filesystem::exists(fileName))
 	{
-		if (!DownloadTaxonomyFile(fileName))
+		// Other versions (i.e. newer taxonomies) must be downloaded by the user
+		if (std::filesystem::path(fileName).filename().string() != taxonomyFileURL.substr(taxonomyFileURL.find_last_of('/') + 1))
+		{
+			errorString = "Taxonomy file '" + fileName + "' not found";
+			return false;
+		}
+		else if (!DownloadTaxonomyFile(fileName))
 		{
 			errorString = "Failed to download the taxonomy file";
 			return false;
 		}
 	}
 	
-	std::ifstream file(fileName);
-	if (!file.good())
+	CacheHeader stamp;
+	const bool haveStamp(GetSourceStamp(fileName, stamp));
+	const std::string cacheFileName(GetCacheFileName(fileName));
+	if (haveStamp && ReadCache(cacheFileName, stamp))
 	{
-		errorString = "Failed to open file at '" + fileName + "'";
-		return false;
+		fingerprint = contentChecksum;
+		BuildDerivedTables();
+		return true;
 	}
 		
-	std::string line;
-	if (!std::getline(file, line))
+	if (!ParseCSV(fileName))
+		return false;
+		
+	contentChecksum = ComputeParsedChecksum();
+	fingerprint = contentChecksum;
+	if (haveStamp)
+		WriteCache(cacheFileName, stamp);// Failing to write the cache is not an error - we'll just parse the .csv again next time
+		
+	BuildDerivedTables();
+	return true;
+}
+
+void TaxonomyOrder::Reset()
+{
+	parsedTaxa.clear();
+	parsedStringPool.clear();
+	parsedLookupTables.clear();
+	internedStrings.clear();
+	cacheFile.Close();
+	
+	taxa = nullptr;
+	taxaCount = 0;
+	stringPool = nullptr;
+	commonNameTable = nullptr;
+	speciesCodeTable = nullptr;
+	scientificNameTable = nullptr;
+	lookupTableSize = 0;
+	contentChecksum = 0;
+	fingerprint = 0;
+	
+	formerNames.clear();
+	formerNameTable.clear();
+	{
+		std::lock_guard<std::mutex> lock(nameIndexMutex);
+		nameIndex.reset();
+	}
+	
+	reportAsIndices.clear();
+	indicesInTaxonomicOrder.clear();
+	countsAsSpecies.clear();
+}
+
+bool TaxonomyOrder::ParseCSV(const std::string& fileName)
+{
+	MemoryMappedFile file;
+	if (!file.Open(fileName))
 	{
-		errorString = "Failed to read taxonomy file header line";
+		errorString = "Failed to open file at '" + fileName + "'";
 		return false;
 	}
-	else if (!HeaderMatches(line))
+	
+	std::string_view text(file.GetData(), file.GetSize());
+	const auto headerEnd(text.find('\n'));
+	std::vector<std::size_t> columnFields;
+	std::string missingColumn;
+	if (!ParseHeader(text.substr(0, headerEnd), columnFields, missingColumn))
 	{
-		errorString = "Unexpected taxonomy file header format";
+		errorString = missingColumn.empty() ? "Unexpected taxonomy file header format" : "Taxonomy file has no " + missingColumn + " column";
 		return false;
 	}
-
-	while (std::getline(file, line))
+	
+	text.remove_prefix(headerEnd == std::string_view::npos ? text.length() : headerEnd + 1);
+	
+	// Small files aren't worth starting threads for
+	const std::size_t threadCount(std::max(std::min<std::size_t>(std::thread::hardware_concurrency(), text.length() / minChunkSize), std::size_t(1)));
+	const auto chunkTexts(SplitCSV(text, threadCount));
+	std::vector<CSVChunk> chunks(chunkTexts.size());
+	std::vector<std::thread> workers;
+	for (std::size_t i = 0; i < chunks.size(); ++i)
 	{
-		TaxaInfo info;
-		if (!ParseLine(line, info))
+		chunks[i].text = chunkTexts[i];
+		if (i > 0)
+			workers.emplace_back(ParseCSVChunk, std::ref(chunks[i]), std::cref(columnFields));
+	}
+	
+	ParseCSVChunk(chunks.front(), columnFields);
+	for (auto& w : workers)
+		w.join();
+		
+	std::size_t recordCount(0);
+	for (const auto& c : chunks)
+	{
+		if (!c.succeeded)
 		{
 			errorString = "Failed to parse taxonomy file";
 			return false;
 		}
+		
+		recordCount += c.records.size();
+	}
+	
+	// Strings are interned in file order, so the string pool (and the cache) is the same regardless of thread count
+	parsedTaxa.reserve(recordCount);
+	for (const auto& c : chunks)
+	{
+		for (const auto& r : c.records)
+		{
+			TaxaInfo info;
+			info.sequence = r.sequence;
+			info.category = r.category;
+			for (std::size_t i = 0; i < csvStringFields.size(); ++i)
+				info.*csvStringFields[i] = Intern(r.strings[i]);
+			parsedTaxa.push_back(info);
+		}
+	}
+	
+	internedStrings.clear();
+	AssignParsedViews();
+	BuildLookupTables();
+	AssignParsedViews();
+	return true;
+}
+
+std::vector<std::string_view> TaxonomyOrder::SplitCSV(const std::string_view& text, const std::size_t& chunkCount)
+{
+	// Whether a newline ends a record depends on the number of quotes before it, so we count quotes up to each split
+	// point (much quicker than parsing), then move the split forward to the end of that record
+	std::vector<std::string_view> chunks;
+	std::string_view::size_type chunkStart(0);
+	std::string_view::size_type position(0);
+	bool inQuotes(false);
+	for (std::size_t i = 1; i < chunkCount; ++i)
+	{
+		const std::string_view::size_type target(text.length() * i / chunkCount);
+		if (target <= chunkStart)
+			continue;
+			
+		while (position < target)
+		{
+			const auto quote(text.find('"', position));
+			if (quote >= target)
+			{
+				position = target;
+				break;
+			}
+			
+			inQuotes = !inQuotes;
+			position = quote + 1;
+		}
+		
+		while (position < text.length())
+		{
+			const auto next(inQuotes ? text.find('"', position) : text.find_first_of("\"\n", position));
+			position = next == std::string_view::npos ? text.length() : next + 1;
+			if (next == std::string_view::npos || text[next] == '\n')
+				break;
+			inQuotes = !inQuotes;
+		}
+		
+		if (position >= text.length())
+			break;
+			
+		chunks.push_back(text.substr(chunkStart, position - chunkStart));
+		chunkStart = position;
+	}
+	
+	chunks.push_back(text.substr(chunkStart));
+	return chunks;
+}
+
+void TaxonomyOrder::ParseCSVChunk(CSVChunk& chunk, const std::vector<std::size_t>& columnFields)
+{
+	std::string_view text(chunk.text);
+	chunk.records.reserve(std::count(text.begin(), text.end(), '\n') + 1);
+	while (!text.empty())
+	{
+		CSVRecord record;
+		bool isBlank;
+		if (!ParseRecord(text, chunk, columnFields, record, isBlank))
+			return;
+			
+		if (!isBlank)
+			chunk.records.push_back(record);
+	}
+	
+	chunk.succeeded = true;
+}
+
+bool TaxonomyOrder::ParseRecord(std::string_view& text, CSVChunk& chunk, const std::vector<std::size_t>& columnFields, CSVRecord& record, bool& isBlank)
+{
+	std::array<std::string_view, csvColumns.size()> fields;
+	std::size_t fieldCount(0);
+	bool endOfRecord(false);
+	while (!endOfRecord)
+	{
+		std::string_view field;
+		if (!NextField(text, chunk, field, endOfRecord))
+			return false;
+			
+		if (fieldCount == 0)
+			isBlank = endOfRecord && field.empty();
+			
+		// Fields in columns we don't read (and beyond the header) are ignored
+		if (fieldCount < columnFields.size() && columnFields[fieldCount] != std::string::npos)
+			fields[columnFields[fieldCount]] = field;
+		++fieldCount;
+	}
+	
+	if (isBlank)
+		return true;
+		
+	// The last field (REPORT_AS in the eBird files) is often blank, in which case the trailing comma is sometimes left off, too
+	if (fieldCount + 1 < columnFields.size() || !ParseField(fields[0], record.sequence) || !ParseField(fields[1], record.category))
+		return false;
+		
+	std::copy(fields.begin() + 2, fields.end(), record.strings.begin());
+	return true;
+}
+
+// Leading whitespace is skipped, and trailing whitespace is removed from the last field in the record (i.e. \r).
+// Quoted fields may contain commas and newlines, with "" standing for a quote.
+bool TaxonomyOrder::NextField(std::string_view& text, CSVChunk& chunk, std::string_view& field, bool& endOfRecord)
+{
+	const char* whitespace(" \t\r\v\f");
+	text.remove_prefix(std::min(text.find_first_not_of(whitespace), text.length()));
+	
+	bool quoted(false);
+	if (!text.empty() && text.front() == '"')
+	{
+		quoted = true;
+		bool escaped(false);
+		std::string_view::size_type end(1);
+		while ((end = text.find('"', end)) != std::string_view::npos && end + 1 < text.length() && text[end + 1] == '"')
+		{
+			escaped = true;
+			end += 2;
+		}
+		
+		if (end == std::string_view::npos)
+			return false;
+			
+		field = text.substr(1, end - 1);
+		text.remove_prefix(end + 1);// Anything between the closing quote and the delimiter is ignored
+		if (escaped)
+		{
+			std::string unescaped;
+			for (std::string_view::size_type i = 0; i < field.length(); ++i)
+			{
+				unescaped.push_back(field[i]);
+				if (field[i] == '"')
+					++i;
+			}
 			
-		taxaInfo.push_back(info);
+			chunk.unescapedFields.push_back(std::move(unescaped));
+			field = chunk.unescapedFields.back();
+		}
 	}
 	
+	const auto delimiter(text.find_first_of(",\n"));
+	endOfRecord = delimiter == std::string_view::npos || text[delimiter] == '\n';
+	if (!quoted)
+	{
+		field = text.substr(0, delimiter);
+		if (endOfRecord)
+			field = field.substr(0, field.find_last_not_of(whitespace) + 1);
+	}
+	
+	text.remove_prefix(delimiter == std::string_view::npos ? text.length() : delimiter + 1);
 	return true;
 }
+
+void TaxonomyOrder::AssignParsedViews()
+{
+	taxa = parsedTaxa.data();
+	taxaCount = static_cast<std::uint32_t>(parsedTaxa.size());
+	stringPool = parsedStringPool.data();
 	
-bool TaxonomyOrder::GetTaxonomicSequence(const std::string& commonName, unsigned int& sequence) const
+	if (parsedLookupTables.empty())
+		return;
+		
+	commonNameTable = parsedLookupTables.data();
+	speciesCodeTable = commonNameTable + lookupTableSize;
+	scientificNameTable = speciesCodeTable + lookupTableSize;
+}
+
+void TaxonomyOrder::BuildLookupTables()
 {
-	for (const auto& t : taxaInfo)
+	// Keep the load factor at or below one half so probe sequences stay short
+	lookupTableSize = 2;
+	while (lookupTableSize < 2 * taxaCount)
+		lookupTableSize *= 2;
+		
+	parsedLookupTables.assign(3 * lookupTableSize, 0);
+	const std::uint32_t mask(lookupTableSize - 1);
+	
+	auto insert([this, mask](std::uint32_t* table, StringReference TaxaInfo::* field, const std::uint32_t& index)
 	{
-		if (t.commonName != commonName)
+		const auto key(GetString(taxa[index].*field));
+		std::uint32_t slot(Hash(key) & mask);
+		while (table[slot] != 0)
+		{
+			// Keep the first entry for duplicate keys, which matches the original linear search
+			if (GetString(taxa[table[slot] - 1].*field) == key)
+				return;
+			slot = (slot + 1) & mask;
+		}
+		
+		table[slot] = index + 1;
+	});
+	
+	for (std::uint32_t i = 0; i < taxaCount; ++i)
+	{
+		insert(parsedLookupTables.data(), &TaxaInfo::commonName, i);
+		insert(parsedLookupTables.data() + lookupTableSize, &TaxaInfo::speciesCode, i);
+		insert(parsedLookupTables.data() + 2 * lookupTableSize, &TaxaInfo::scientificName, i);
+	}
+}
+	
+void TaxonomyOrder::BuildDerivedTables()
+{
+	reportAsIndices.resize(taxaCount);
+	indicesInTaxonomicOrder.resize(taxaCount);
+	countsAsSpecies.resize(taxaCount);
+	for (std::uint32_t i = 0; i < taxaCount; ++i)
+	{
+		indicesInTaxonomicOrder[i] = i;
+		countsAsSpecies[i] = taxa[i].category != Category::Spuh &&
+			taxa[i].category != Category::Slash &&
+			taxa[i].category != Category::Hybrid &&
+			taxa[i].category != Category::Domestic;
+		if (taxa[i].reportAs.length > 0 &&
+			LookUpIndex(speciesCodeTable, &TaxaInfo::speciesCode, GetString(taxa[i].reportAs), reportAsIndices[i]))
 			continue;
-		sequence = t.sequence;
-		return true;
+			
+		// eBird leaves REPORT_AS blank for domestic types, so these go to the species with the same binomial instead
+		if (taxa[i].category == Category::Domestic && LookUpSpeciesByBinomial(GetString(taxa[i].scientificName), reportAsIndices[i]))
+			continue;
+			
+		reportAsIndices[i] = i;
 	}
 	
-	return false;
+	// The file is normally in taxonomic order already, in which case this is just a check
+	auto sequenceLess([this](const unsigned int& a, const unsigned int& b)
+	{
+		return taxa[a].sequence < taxa[b].sequence;
+	});
+	if (!std::is_sorted(indicesInTaxonomicOrder.begin(), indicesInTaxonomicOrder.end(), sequenceLess))
+		std::stable_sort(indicesInTaxonomicOrder.begin(), indicesInTaxonomicOrder.end(), sequenceLess);
 }
 
-bool TaxonomyOrder::ParseLine(std::string line, TaxaInfo& info)
+bool TaxonomyOrder::LookUpSpeciesByBinomial(const std::string_view& scientificName, unsigned int& index) const
 {
-	Trim(line);
-	std::istringstream ss(line);
-	std::string token;
-	if (!GetNextToken(ss, token) || !ParseToken(token, info.sequence))
+	// i.e. "Anas platyrhynchos (Domestic type)" -> "Anas platyrhynchos"
+	const auto genusEnd(scientificName.find(' '));
+	if (genusEnd == std::string_view::npos)
 		return false;
 		
-	if (!GetNextToken(ss, token) || !ParseToken(token, info.category))
+	const std::string_view binomial(scientificName.substr(0, scientificName.find(' ', genusEnd + 1)));
+	return binomial != scientificName &&
+		LookUpIndex(scientificNameTable, &TaxaInfo::scientificName, binomial, index) &&
+		taxa[index].category == Category::Species;
+}
+
+bool TaxonomyOrder::GetTaxonIndex(const std::string_view& commonName, unsigned int& index) const
+{
+	return LookUpIndex(commonNameTable, &TaxaInfo::commonName, commonName, index) || LookUpFormerName(commonName, index);
+}
+
+bool TaxonomyOrder::GetTaxonIndexFromSpeciesCode(const std::string_view& speciesCode, unsigned int& index) const
+{
+	return LookUpIndex(speciesCodeTable, &TaxaInfo::speciesCode, speciesCode, index);
+}
+
+bool TaxonomyOrder::GetTaxonIndexFromScientificName(const std::string_view& scientificName, unsigned int& index) const
+{
+	return LookUpIndex(scientificNameTable, &TaxaInfo::scientificName, scientificName, index);
+}
+
+bool TaxonomyOrder::GetTaxonomicSequence(const std::string_view& commonName, unsigned int& sequence) const
+{
+	unsigned int index;
+	if (!GetTaxonIndex(commonName, index))
 		return false;
 		
-	if (!GetNextToken(ss, token) || !ParseToken(token, info.speciesCode))
-		return false;
+	sequence = taxa[index].sequence;
+	return true;
+}
+
+void TaxonomyOrder::SetFormerNames(std::vector<FormerName> names)
+{
+	{
+		std::lock_guard<std::mutex> lock(nameIndexMutex);
+		nameIndex.reset();
+	}
+	
+	formerNames.clear();
+	formerNameTable.clear();
+	if (lookupTableSize == 0)
+		return;
 		
-	if (!GetNextToken(ss, token) || !ParseToken(token, info.commonName))
-		return false;
+	// Sized for every name, like BuildLookupTables(), so none are ever dropped
+	std::uint32_t formerNameTableSize(2);
+	while (formerNameTableSize < 2 * names.size())
+		formerNameTableSize *= 2;
+		
+	formerNameTable.assign(formerNameTableSize, 0);
+	const std::uint32_t mask(formerNameTableSize - 1);
+	for (auto& n : names)
+	{
+		unsigned int index;
+		if (n.index >= taxaCount || LookUpIndex(commonNameTable, &TaxaInfo::commonName, n.name, index))
+			continue;
+			
+		// Keep the first entry for duplicate names
+		std::uint32_t slot(Hash(n.name) & mask);
+		while (formerNameTable[slot] != 0 && formerNames[formerNameTable[slot] - 1].name != n.name)
+			slot = (slot + 1) & mask;
+		if (formerNameTable[slot] != 0)
+			continue;
+			
+		formerNames.push_back(std::move(n));
+		formerNameTable[slot] = static_cast<std::uint32_t>(formerNames.size());
+	}
+	
+	fingerprint = contentChecksum;
+	for (const auto& n : formerNames)
+	{
+		const std::uint64_t index(n.index);
+		fingerprint = ComputeChecksum(n.name.data(), n.name.length(), fingerprint);
+		fingerprint = ComputeChecksum(reinterpret_cast<const char*>(&index), sizeof(index), fingerprint);
+	}
+}
 
-	if (!GetNextToken(ss, token) || !ParseToken(token, info.scientificName))
+bool TaxonomyOrder::MatchTaxonIndex(const std::string_view& name, unsigned int& index) const
+{
+	const SpeciesNameIndex* matcher;
+	{
+		std::lock_guard<std::mutex> lock(nameIndexMutex);
+		if (!nameIndex)
+		{
+			std::vector<std::pair<std::string_view, unsigned int>> names;
+			names.reserve(taxaCount + formerNames.size());
+			for (unsigned int i = 0; i < taxaCount; ++i)
+				names.push_back(std::make_pair(GetCommonName(i), i));
+			for (const auto& f : formerNames)
+				names.push_back(std::make_pair(std::string_view(f.name), f.index));
+			nameIndex = std::make_unique<const SpeciesNameIndex>(names);
+		}
+		
+		matcher = nameIndex.get();
+	}
+	
+	// The index doesn't change once built (until the taxonomy itself is reloaded)
+	return matcher->Find(name, index);
+}
+
+bool TaxonomyOrder::LookUpFormerName(const std::string_view& commonName, unsigned int& index) const
+{
+	if (formerNames.empty())
 		return false;
 		
-	if (!GetNextToken(ss, token) || !ParseToken(token, info.order))
+	const std::uint32_t mask(static_cast<std::uint32_t>(formerNameTable.size()) - 1);
+	std::uint32_t slot(Hash(commonName) & mask);
+	while (formerNameTable[slot] != 0)
+	{
+		const FormerName& formerName(formerNames[formerNameTable[slot] - 1]);
+		if (formerName.name == commonName)
+		{
+			index = formerName.index;
+			return true;
+		}
+		
+		slot = (slot + 1) & mask;
+	}
+	
+	return false;
+}
+
+bool TaxonomyOrder::GetTaxonomicSequenceFromSpeciesCode(const std::string_view& speciesCode, unsigned int& sequence) const
+{
+	return LookUpSequence(speciesCodeTable, &TaxaInfo::speciesCode, speciesCode, sequence);
+}
+
+bool TaxonomyOrder::GetTaxonomicSequenceFromScientificName(const std::string_view& scientificName, unsigned int& sequence) const
+{
+	return LookUpSequence(scientificNameTable, &TaxaInfo::scientificName, scientificName, sequence);
+}
+
+bool TaxonomyOrder::LookUpIndex(const std::uint32_t* table, StringReference TaxaInfo::* field, const std::string_view& key, unsigned int& index) const
+{
+	if (!table)
 		return false;
 		
-	if (!GetNextToken(ss, token) || !ParseToken(token, info.family))
+	const std::uint32_t mask(lookupTableSize - 1);
+	std::uint32_t slot(Hash(key) & mask);
+	while (table[slot] != 0)
+	{
+		if (GetString(taxa[table[slot] - 1].*field) == key)
+		{
+			index = table[slot] - 1;
+			return true;
+		}
+		
+		slot = (slot + 1) & mask;
+	}
+	
+	return false;
+}
+
+bool TaxonomyOrder::LookUpSequence(const std::uint32_t* table, StringReference TaxaInfo::* field, const std::string_view& key, unsigned int& sequence) const
+{
+	unsigned int index;
+	if (!LookUpIndex(table, field, key, index))
 		return false;
 		
-	if (!GetNextToken(ss, token) || !ParseToken(token, info.speciesGroup))
+	sequence = taxa[index].sequence;
+	return true;
+}
+
+std::uint32_t TaxonomyOrder::Hash(const std::string_view& s)
+{
+	// 32-bit FNV-1a
+	std::uint32_t hash(2166136261u);
+	for (const auto& c : s)
+	{
+		hash ^= static_cast<unsigned char>(c);
+		hash *= 16777619u;
+	}
+	
+	return hash;
+}
+
+TaxonomyOrder::StringReference TaxonomyOrder::Intern(const std::string_view& s)
+{
+	if (s.empty())
+		return StringReference();
+		
+	const auto it(internedStrings.find(s));
+	if (it != internedStrings.end())
+		return it->second;
+		
+	StringReference reference;
+	reference.offset = static_cast<std::uint32_t>(parsedStringPool.size());
+	reference.length = static_cast<std::uint32_t>(s.length());
+	parsedStringPool.append(s);
+	internedStrings.emplace(s, reference);
+	return reference;
+}
+
+bool TaxonomyOrder::GetSourceStamp(const std::string& fileName, CacheHeader& header)
+{
+	std::error_code ec;
+	const auto size(std::filesystem::file_size(fileName, ec));
+	if (ec)
 		return false;
 		
-	GetNextToken(ss, token);// Don't return if the last one fails - it just means the token is blank
-	if (!ParseToken(token, info.reportAs))
+	const auto modifiedTime(std::filesystem::last_write_time(fileName, ec));
+	if (ec)
 		return false;
 		
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, cacheMagic, sizeof(header.magic));
+	header.version = cacheVersion;
+	header.sourceSize = static_cast<std::uint64_t>(size);
+	header.sourceModifiedTime = static_cast<std::int64_t>(modifiedTime.time_since_epoch().count());
 	return true;
 }
 
-bool TaxonomyOrder::GetNextToken(std::istringstream& ss, std::string& token)
+bool TaxonomyOrder::ReadCache(const std::string& cacheFileName, const CacheHeader& expected)
 {
-	ss >> std::ws;// Discard leading whitespace
-	if (ss.peek() == '"')// Process quoted string
+	if (!cacheFile.Open(cacheFileName))
+		return false;
+		
+	CacheHeader header;
+	if (cacheFile.GetSize() < sizeof(header))
+	{
+		cacheFile.Close();
+		return false;
+	}
+	
+	std::memcpy(&header, cacheFile.GetData(), sizeof(header));
+	if (std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0 ||
+		header.version != expected.version ||
+		header.sourceSize != expected.sourceSize ||
+		header.sourceModifiedTime != expected.sourceModifiedTime)
+	{
+		cacheFile.Close();
+		return false;
+	}
+	
+	const std::size_t recordsSize(static_cast<std::size_t>(header.taxaCount) * sizeof(TaxaInfo));
+	const std::size_t tablesSize(static_cast<std::size_t>(header.lookupTableSize) * 3 * sizeof(std::uint32_t));
+	const std::size_t payloadSize(recordsSize + tablesSize + PaddedSize(header.stringPoolSize));
+	if (header.lookupTableSize == 0 || (header.lookupTableSize & (header.lookupTableSize - 1)) != 0 ||
+		cacheFile.GetSize() != sizeof(header) + payloadSize ||
+		ComputeChecksum(cacheFile.GetData() + sizeof(header), payloadSize) != header.checksum)
 	{
-		ss >> std::quoted(token);
+		cacheFile.Close();
+		return false;
 	}
 	
-	return !std::getline(ss, token, ',').fail();
+	const char* payload(cacheFile.GetData() + sizeof(header));
+	taxa = reinterpret_cast<const TaxaInfo*>(payload);
+	taxaCount = header.taxaCount;
+	lookupTableSize = header.lookupTableSize;
+	commonNameTable = reinterpret_cast<const std::uint32_t*>(payload + recordsSize);
+	speciesCodeTable = commonNameTable + lookupTableSize;
+	scientificNameTable = speciesCodeTable + lookupTableSize;
+	stringPool = payload + recordsSize + tablesSize;
+	contentChecksum = header.checksum;
+	
+	return true;
 }
 
-bool TaxonomyOrder::HeaderMatches(std::string& headerLine)
+bool TaxonomyOrder::WriteCache(const std::string& cacheFileName, CacheHeader header) const
 {
-	// For some reason, the eBird taxonomy file starts with three negative-valued characters, which seem to be ignored by text editors.
-	// We'll ignore them here, too, along with any whitespace characters (this works to remove trailing whitespace, like \r, which is
-	// included in the line, but we can only use it here because we know the expected line doesn't contain any whitespace).
-	headerLine.erase(std::remove_if(headerLine.begin(), headerLine.end(), [](const std::string::value_type& c)
+	header.taxaCount = taxaCount;
+	header.lookupTableSize = lookupTableSize;
+	header.stringPoolSize = static_cast<std::uint32_t>(parsedStringPool.size());
+	
+	std::string payload;
+	payload.reserve(parsedTaxa.size() * sizeof(TaxaInfo) + parsedLookupTables.size() * sizeof(std::uint32_t) + PaddedSize(parsedStringPool.size()));
+	payload.append(reinterpret_cast<const char*>(parsedTaxa.data()), parsedTaxa.size() * sizeof(TaxaInfo));
+	payload.append(reinterpret_cast<const char*>(parsedLookupTables.data()), parsedLookupTables.size() * sizeof(std::uint32_t));
+	payload.append(parsedStringPool);
+	payload.resize(PaddedSize(payload.size()), '\0');
+	header.checksum = contentChecksum;
+	
+	// Write to a temporary file first so a partially written cache is never picked up
+	const std::string tempFileName(cacheFileName + ".tmp");
 	{
-		if (static_cast<int>(c) < 0 || std::isspace(c))
-			return true;
+		std::ofstream file(tempFileName, std::ios::binary | std::ios::trunc);
+		if (!file.good())
+			return false;
+			
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(payload.data(), payload.size());
+		if (!file.good())
+			return false;
+	}
+	
+	std::error_code ec;
+	std::filesystem::rename(tempFileName, cacheFileName, ec);
+	if (ec)
+	{
+		std::filesystem::remove(tempFileName, ec);
 		return false;
-	}), headerLine.end());
+	}
 	
-	const std::string expectedHeader("TAXON_ORDER,CATEGORY,SPECIES_CODE,PRIMARY_COM_NAME,SCI_NAME,ORDER1,FAMILY,SPECIES_GROUP,REPORT_AS");
-	return headerLine == expectedHeader;
+	return true;
 }
 
-bool TaxonomyOrder::ParseToken(const std::string& s, std::string& value)
+// Same as the checksum of the payload WriteCache() builds, without building it
+std::uint64_t TaxonomyOrder::ComputeParsedChecksum() const
 {
-	value = s;
-	return true;
+	std::uint64_t checksum(ComputeChecksum(reinterpret_cast<const char*>(parsedTaxa.data()), parsedTaxa.size() * sizeof(TaxaInfo)));
+	checksum = ComputeChecksum(reinterpret_cast<const char*>(parsedLookupTables.data()), parsedLookupTables.size() * sizeof(std::uint32_t), checksum);
+	return ComputeChecksum(parsedStringPool.data(), parsedStringPool.size(), checksum);
 }
 
-void TaxonomyOrder::Trim(std::string& s)
+std::uint64_t TaxonomyOrder::ComputeChecksum(const char* data, const std::size_t& size, const std::uint64_t& previousChecksum)
 {
-	s.erase(s.begin(), std::find_if(s.begin(), s.end(), [](const unsigned char& ch)
+	// 64-bit FNV-1a applied a word at a time, with any partial word at the end padded with zeros
+	std::uint64_t checksum(previousChecksum);
+	for (std::size_t i = 0; i < size; i += sizeof(std::uint64_t))
 	{
-		return !std::isspace(ch);
-	}));
+		std::uint64_t word(0);
+		std::memcpy(&word, data + i, std::min(sizeof(word), size - i));
+		checksum ^= word;
+		checksum *= 1099511628211ull;
+	}
 	
-	s.erase(std::find_if(s.rbegin(), s.rend(), [](const unsigned int &ch)
+	return checksum;
+}
+
+bool TaxonomyOrder::ParseHeader(std::string_view headerLine, std::vector<std::size_t>& columnFields, std::string& missingColumn)
+{
+	// For some reason, the eBird taxonomy file starts with three negative-valued characters (a UTF-8 byte order mark),
+	// which seem to be ignored by text editors.  We'll ignore them here, too.
+	while (!headerLine.empty() && static_cast<int>(headerLine.front()) < 0)
+		headerLine.remove_prefix(1);
+		
+	CSVChunk chunk;// Only needed for quoted names
+	std::array<bool, csvColumns.size()> found;
+	found.fill(false);
+	bool endOfRecord(false);
+	while (!endOfRecord)
 	{
-		return !std::isspace(ch);
-	}).base(), s.end());
+		std::string_view name;
+		if (!NextField(headerLine, chunk, name, endOfRecord))
+			return false;
+			
+		name = name.substr(0, name.find_last_not_of(" \t\r\v\f") + 1);
+		columnFields.push_back(std::string::npos);
+		for (std::size_t i = 0; i < csvColumns.size(); ++i)
+		{
+			// Where a column appears more than once, the first is used
+			if (!found[i] && std::find(csvColumns[i].names.begin(), csvColumns[i].names.end(), name) != csvColumns[i].names.end())
+			{
+				columnFields.back() = i;
+				found[i] = true;
+				break;
+			}
+		}
+	}
+	
+	for (std::size_t i = 0; i < csvColumns.size(); ++i)
+	{
+		if (csvColumns[i].required && !found[i])
+		{
+			missingColumn = csvColumns[i].names.front();
+			return false;
+		}
+	}
+	
+	return true;
+}
+
+bool TaxonomyOrder::ParseField(const std::string_view& field, std::uint32_t& value)
+{
+	// Fields are allowed to be blank
+	if (field.empty())
+		return true;
+		
+	// The whole field must be the number (i.e. "417abc" and "12.5" are errors, not 417 and 12)
+	const char* end(field.data() + field.length());
+	const auto result(std::from_chars(field.data(), end, value));
+	return result.ec == std::errc() && result.ptr == end;
 }
 
-bool TaxonomyOrder::ParseToken(const std::string& s, TaxaInfo::Category& value)
+bool TaxonomyOrder::ParseField(const std::string_view& field, Category& value)
 {
-	if (s == "species")
-		value = TaxaInfo::Category::Species;
-	else if (s == "hybrid")
-		value = TaxaInfo::Category::Hybrid;
-	else if (s == "spuh")
-		value = TaxaInfo::Category::Spuh;
-	else if (s == "slash")
-		value = TaxaInfo::Category::Slash;
-	else if (s == "issf")
-		value = TaxaInfo::Category::IdentifiableSubSpecificGroup;
-	else if (s == "intergrade")
-		value = TaxaInfo::Category::Intergrade;
-	else if (s == "domestic")
-		value = TaxaInfo::Category::Domestic;
-	else if (s == "form")
-		value = TaxaInfo::Category::Form;
+	if (field == "species")
+		value = Category::Species;
+	else if (field == "hybrid")
+		value = Category::Hybrid;
+	else if (field == "spuh")
+		value = Category::Spuh;
+	else if (field == "slash")
+		value = Category::Slash;
+	else if (field == "issf")
+		value = Category::IdentifiableSubSpecificGroup;
+	else if (field == "intergrade")
+		value = Category::Intergrade;
+	else if (field == "domestic")
+		value = Category::Domestic;
+	else if (field == "form")
+		value = Category::Form;
 	else
 		return false;
 
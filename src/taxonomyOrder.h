@@ -8,77 +8,238 @@
 #ifndef TAXONOMY_ORDER_H_
 #define TAXONOMY_ORDER_H_
 
+// Local headers
+#include "memoryMappedFile.h"
+
 // Standard C++ headers
 #include <string>
+#include <string_view>
 #include <vector>
-#include <sstream>
+#include <array>
+#include <deque>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+#include <type_traits>
+
+// Local forward declarations
+class SpeciesNameIndex;
 
 class TaxonomyOrder
 {
 public:
-	explicit TaxonomyOrder(const std::string& userAgent) : userAgent(userAgent) {}
+	explicit TaxonomyOrder(const std::string& userAgent);
+	~TaxonomyOrder();
+	// Lookups hold pointers into our own storage, so copies would dangle
+	TaxonomyOrder(const TaxonomyOrder&) = delete;
+	TaxonomyOrder& operator=(const TaxonomyOrder&) = delete;
+
+	// Loads the precompiled cache next to fileName if it is current, otherwise parses the .csv and rewrites the cache
 	bool Parse(const std::string& fileName);
 	
-	bool GetTaxonomicSequence(const std::string& commonName, unsigned int& sequence) const;
+	bool GetTaxonomicSequence(const std::string_view& commonName, unsigned int& sequence) const;
+	bool GetTaxonomicSequenceFromSpeciesCode(const std::string_view& speciesCode, unsigned int& sequence) const;
+	bool GetTaxonomicSequenceFromScientificName(const std::string_view& scientificName, unsigned int& sequence) const;
+	
+	// Each taxon is also identified by a dense index in [0, GetTaxonCount()), which is convenient for flat lookup tables
+	unsigned int GetTaxonCount() const { return taxaCount; }
+	bool GetTaxonIndex(const std::string_view& commonName, unsigned int& index) const;
+	bool GetTaxonIndexFromSpeciesCode(const std::string_view& speciesCode, unsigned int& index) const;
+	bool GetTaxonIndexFromScientificName(const std::string_view& scientificName, unsigned int& index) const;
+	unsigned int GetTaxonomicSequence(const unsigned int& index) const { return taxa[index].sequence; }
+	std::string_view GetCommonName(const unsigned int& index) const { return GetString(taxa[index].commonName); }
+	std::string_view GetSpeciesCode(const unsigned int& index) const { return GetString(taxa[index].speciesCode); }
+	std::string_view GetScientificName(const unsigned int& index) const { return GetString(taxa[index].scientificName); }
+	
+	// Common names from earlier versions of the taxonomy, each with the index of the taxon which replaced it here.  Lookups
+	// by common name fall back to these, so checklists using either version's names can be compiled together.
+	struct FormerName
+	{
+		std::string name;
+		unsigned int index;
+	};
+	
+	void SetFormerNames(std::vector<FormerName> names);// Names which are current in this version are ignored
+	
+	// For names GetTaxonIndex() doesn't recognize:  matches ignoring HTML entities, apostrophe and dash styles, case and
+	// spacing, then allows for a typo or two.  The index behind this is built the first time it's needed.
+	bool MatchTaxonIndex(const std::string_view& name, unsigned int& index) const;
+	// Taxa are reported as their REPORT_AS parent (subspecific groups, forms, etc.), or for domestic types, as the species
+	// with the same binomial; species and anything else without a parent report as themselves
+	unsigned int GetReportAsIndex(const unsigned int& index) const { return reportAsIndices[index]; }
+	
+	enum class Category : std::uint32_t
+	{
+		Species,
+		Hybrid,
+		Spuh,
+		Slash,
+		IdentifiableSubSpecificGroup,
+		Intergrade,
+		Domestic,
+		Form
+	};
+	
+	Category GetCategory(const unsigned int& index) const { return taxa[index].category; }
+	// Spuhs, slashes and hybrids are not identified to a single species, and domestic types don't count under eBird's
+	// rules, so none of these add to species totals
+	bool CountsAsSpecies(const unsigned int& index) const { return countsAsSpecies[index]; }
+	const std::vector<unsigned int>& GetIndicesInTaxonomicOrder() const { return indicesInTaxonomicOrder; }
 	
 	std::string GetErrorString() const { return errorString; }
+	
+	// Changes whenever the taxa or the former names do, so anything derived from the taxonomy (i.e. parsed
+	// checklists) can be checked against the taxonomy it came from
+	std::uint64_t GetFingerprint() const { return fingerprint; }
+	
+	static std::string GetCacheFileName(const std::string& fileName) { return fileName + cacheFileExtension; }
 
 private:
 	static const std::string taxonomyFileURL;
+	static const std::string cacheFileExtension;
 	const std::string userAgent;
 	
 	std::string errorString;
+	
+	// Location of a string within the string pool
+	struct StringReference
+	{
+		std::uint32_t offset = 0;
+		std::uint32_t length = 0;
+	};
 
+	// Fixed-width record, written directly to (and mapped directly from) the cache file
 	struct TaxaInfo
 	{
-		enum class Category
-		{
-			Species,
-			Hybrid,
-			Spuh,
-			Slash,
-			IdentifiableSubSpecificGroup,
-			Intergrade,
-			Domestic,
-			Form
-		};
-	
-		unsigned int sequence;
-		Category category;
-		std::string speciesCode;
-		std::string commonName;
-		std::string scientificName;
-		std::string order;
-		std::string family;
-		std::string speciesGroup;
-		std::string reportAs;
+		std::uint32_t sequence = 0;
+		Category category = Category::Species;
+		StringReference speciesCode;
+		StringReference commonName;
+		StringReference scientificName;
+		StringReference order;
+		StringReference family;
+		StringReference speciesGroup;
+		StringReference reportAs;
 	};
 	
-	std::vector<TaxaInfo> taxaInfo;
+	static_assert(std::is_trivially_copyable<TaxaInfo>::value, "TaxaInfo must be trivially copyable to be stored in the cache");
+	static_assert(sizeof(TaxaInfo) % 8 == 0, "TaxaInfo must keep the cache sections aligned");
+	
+	// Storage used when data comes from the .csv file
+	std::vector<TaxaInfo> parsedTaxa;
+	std::string parsedStringPool;
+	std::vector<std::uint32_t> parsedLookupTables;
+	std::unordered_map<std::string_view, StringReference> internedStrings;// Only used while parsing; keys refer to the parsed text
+	
+	// Storage used when data comes from the cache file
+	MemoryMappedFile cacheFile;
+	
+	// Views of whichever storage is in use
+	const TaxaInfo* taxa = nullptr;
+	std::uint32_t taxaCount = 0;
+	const char* stringPool = nullptr;
+	// Open-addressed tables of (record index + 1), with zero marking an empty slot
+	const std::uint32_t* commonNameTable = nullptr;
+	const std::uint32_t* speciesCodeTable = nullptr;
+	const std::uint32_t* scientificNameTable = nullptr;
+	std::uint32_t lookupTableSize = 0;// Per table; always a power of two
+	
+	// Open-addressed table of (formerNames index + 1), with its own power of two size (at least twice the number of names)
+	std::vector<FormerName> formerNames;
+	std::vector<std::uint32_t> formerNameTable;
+	bool LookUpFormerName(const std::string_view& commonName, unsigned int& index) const;
+	
+	std::uint64_t contentChecksum = 0;// Of the cache file payload, whether or not the data came from the cache
+	std::uint64_t fingerprint = 0;
 	
-	bool ParseLine(std::string line, TaxaInfo& info);
-	static bool HeaderMatches(std::string& headerLine);
+	mutable std::mutex nameIndexMutex;
+	mutable std::unique_ptr<const SpeciesNameIndex> nameIndex;// Current and former names
 	
-	template <typename T>
-	bool ParseToken(const std::string& s, T& value);
-	bool ParseToken(const std::string& s, std::string& value);
-	bool ParseToken(const std::string& s, TaxaInfo::Category& value);
+	// Derived from the taxa after loading
+	std::vector<unsigned int> reportAsIndices;
+	std::vector<unsigned int> indicesInTaxonomicOrder;
+	std::vector<bool> countsAsSpecies;
 	
-	static void Trim(std::string& s);
-	static bool GetNextToken(std::istringstream& ss, std::string& token);
+	void Reset();
+	bool ParseCSV(const std::string& fileName);
+	void BuildLookupTables();
+	void AssignParsedViews();
+	void BuildDerivedTables();
+	bool LookUpSpeciesByBinomial(const std::string_view& scientificName, unsigned int& index) const;
+	
+	std::string_view GetString(const StringReference& reference) const { return std::string_view(stringPool + reference.offset, reference.length); }
+	StringReference Intern(const std::string_view& s);
+	static std::uint32_t Hash(const std::string_view& s);
+	bool LookUpIndex(const std::uint32_t* table, StringReference TaxaInfo::* field, const std::string_view& key, unsigned int& index) const;
+	bool LookUpSequence(const std::uint32_t* table, StringReference TaxaInfo::* field, const std::string_view& key, unsigned int& sequence) const;
+	
+	struct CacheHeader
+	{
+		char magic[8];
+		std::uint32_t version;
+		std::uint32_t taxaCount;
+		std::uint64_t sourceSize;
+		std::int64_t sourceModifiedTime;
+		std::uint32_t lookupTableSize;
+		std::uint32_t stringPoolSize;
+		std::uint64_t checksum;// Of everything following the header
+	};
+	
+	static_assert(sizeof(CacheHeader) % 8 == 0, "CacheHeader must keep the cache sections aligned");
+	
+	static const char cacheMagic[8];
+	static const std::uint32_t cacheVersion;
+	
+	static bool GetSourceStamp(const std::string& fileName, CacheHeader& header);
+	bool ReadCache(const std::string& cacheFileName, const CacheHeader& expected);
+	bool WriteCache(const std::string& cacheFileName, CacheHeader header) const;
+	std::uint64_t ComputeParsedChecksum() const;
+	static const std::uint64_t initialChecksum;
+	static std::uint64_t ComputeChecksum(const char* data, const std::size_t& size, const std::uint64_t& previousChecksum = initialChecksum);
+	static std::size_t PaddedSize(const std::size_t& size) { return (size + 7) & ~static_cast<std::size_t>(7); }
+	
+	// The .csv is split into chunks of whole records, which are parsed on separate threads.  Fields refer to the
+	// mapped file until they're interned, which is done in file order once every chunk is parsed.
+	static const std::size_t minChunkSize;// [bytes]
+	static const std::array<StringReference TaxaInfo::*, 7> csvStringFields;// Following TAXON_ORDER and CATEGORY in csvColumns
+	
+	// Columns are found by name, since the layout differs between versions of the file (and unused columns are
+	// optional).  These are in the order of CSVRecord's fields, each with every name it's been given.
+	struct CSVColumn
+	{
+		std::vector<std::string> names;
+		bool required;
+	};
+	
+	static const std::array<CSVColumn, 9> csvColumns;
+	
+	struct CSVRecord
+	{
+		std::uint32_t sequence = 0;
+		Category category = Category::Species;
+		std::array<std::string_view, 7> strings;// See csvStringFields; blank for missing columns
+	};
+	
+	struct CSVChunk
+	{
+		std::string_view text;
+		std::vector<CSVRecord> records;
+		std::deque<std::string> unescapedFields;// Quoted fields containing "", which can't refer to the file
+		bool succeeded = false;
+	};
+	
+	static std::vector<std::string_view> SplitCSV(const std::string_view& text, const std::size_t& chunkCount);
+	// columnFields holds the csvColumns index for each column in the file, or npos for columns which aren't read
+	static bool ParseHeader(std::string_view headerLine, std::vector<std::size_t>& columnFields, std::string& missingColumn);
+	static void ParseCSVChunk(CSVChunk& chunk, const std::vector<std::size_t>& columnFields);
+	static bool ParseRecord(std::string_view& text, CSVChunk& chunk, const std::vector<std::size_t>& columnFields, CSVRecord& record, bool& isBlank);
+	static bool NextField(std::string_view& text, CSVChunk& chunk, std::string_view& field, bool& endOfRecord);
+	
+	static bool ParseField(const std::string_view& field, std::uint32_t& value);
+	static bool ParseField(const std::string_view& field, Category& value);
 	
 	bool DownloadTaxonomyFile(const std::string& saveTo);
 };
 
-template <typename T>
-bool TaxonomyOrder::ParseToken(const std::string& s, T& value)
-{
-	// Fields are allowed to be blank
-	if (s.empty())
-		return true;
-		
-	std::istringstream ss(s);
-	return !(ss >> value).fail();
-}
-
 #endif// TAXONOMY_ORDER_H_
@@ -0,0 +1,97 @@
+// File:  taxonomyRegistry.cpp
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Several versions of the eBird taxonomy loaded side by side, with each taxon of an earlier
+//        version mapped to the taxon which replaced it in the current version.  Earlier common
+//        names are given to the current version, so checklists from different years compile together.
+
+// Local headers
+#include "taxonomyRegistry.h"
+#include "taxonomyOrder.h"
+
+// Standard C++ headers
+#include <limits>
+
+const std::uint32_t TaxonomyRegistry::noMatch(std::numeric_limits<std::uint32_t>::max());
+
+TaxonomyRegistry::TaxonomyRegistry(const std::string& userAgent) : userAgent(userAgent)
+{
+}
+
+TaxonomyRegistry::~TaxonomyRegistry() = default;
+
+bool TaxonomyRegistry::Load(const std::vector<std::string>& fileNames)
+{
+	versions.clear();
+	if (fileNames.empty())
+	{
+		errorString = "No taxonomy files specified";
+		return false;
+	}
+	
+	// Each version is normally loaded from its own precompiled cache, so this is quick even for several versions
+	for (const auto& f : fileNames)
+	{
+		Version version;
+		version.fileName = f;
+		version.taxonomy = std::make_unique<TaxonomyOrder>(userAgent);
+		if (!version.taxonomy->Parse(f))
+		{
+			errorString = version.taxonomy->GetErrorString();
+			versions.clear();
+			return false;
+		}
+		
+		versions.push_back(std::move(version));
+	}
+	
+	BuildMappings();
+	return true;
+}
+
+bool TaxonomyRegistry::MapToCurrent(const std::size_t& version, const unsigned int& index, unsigned int& currentIndex) const
+{
+	if (version == 0)
+	{
+		currentIndex = index;
+		return true;
+	}
+	
+	if (versions[version].currentIndices[index] == noMatch)
+		return false;
+		
+	currentIndex = versions[version].currentIndices[index];
+	return true;
+}
+
+void TaxonomyRegistry::BuildMappings()
+{
+	TaxonomyOrder& current(*versions.front().taxonomy);
+	std::vector<TaxonomyOrder::FormerName> formerNames;
+	for (auto v = versions.begin() + 1; v != versions.end(); ++v)
+	{
+		const TaxonomyOrder& previous(*v->taxonomy);
+		v->currentIndices.resize(previous.GetTaxonCount());
+		for (unsigned int i = 0; i < previous.GetTaxonCount(); ++i)
+		{
+			v->currentIndices[i] = FindCurrentIndex(current, previous, i);
+			if (v->currentIndices[i] != noMatch)
+				formerNames.push_back(TaxonomyOrder::FormerName{ std::string(previous.GetCommonName(i)), v->currentIndices[i] });
+		}
+	}
+	
+	current.SetFormerNames(std::move(formerNames));
+}
+
+// Species codes are kept when only the common name changes, and are replaced when a taxon is split or lumped, so
+// they're the best indication of what a taxon became.  Taxa without a matching code fall back to the scientific name
+// (i.e. the code was changed to follow a new common name), then to the common name (i.e. a new genus).
+std::uint32_t TaxonomyRegistry::FindCurrentIndex(const TaxonomyOrder& current, const TaxonomyOrder& previous, const unsigned int& index)
+{
+	unsigned int currentIndex;
+	if ((!previous.GetSpeciesCode(index).empty() && current.GetTaxonIndexFromSpeciesCode(previous.GetSpeciesCode(index), currentIndex)) ||
+		(!previous.GetScientificName(index).empty() && current.GetTaxonIndexFromScientificName(previous.GetScientificName(index), currentIndex)) ||
+		current.GetTaxonIndex(previous.GetCommonName(index), currentIndex))
+		return currentIndex;
+	return noMatch;
+}
@@ -0,0 +1,58 @@
+// File:  taxonomyRegistry.h
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Several versions of the eBird taxonomy loaded side by side, with each taxon of an earlier
+//        version mapped to the taxon which replaced it in the current version.  Earlier common
+//        names are given to the current version, so checklists from different years compile together.
+
+#ifndef TAXONOMY_REGISTRY_H_
+#define TAXONOMY_REGISTRY_H_
+
+// Standard C++ headers
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+// Local forward declarations
+class TaxonomyOrder;
+
+class TaxonomyRegistry
+{
+public:
+	explicit TaxonomyRegistry(const std::string& userAgent);
+	~TaxonomyRegistry();
+	
+	// The first file is the current taxonomy, which checklists are compiled against.  The rest are earlier versions,
+	// most recent first (where versions disagree about a name, the most recent wins).
+	bool Load(const std::vector<std::string>& fileNames);
+	std::string GetErrorString() const { return errorString; }
+	
+	const TaxonomyOrder& GetCurrent() const { return *versions.front().taxonomy; }
+	std::size_t GetVersionCount() const { return versions.size(); }
+	const TaxonomyOrder& GetVersion(const std::size_t& version) const { return *versions[version].taxonomy; }
+	const std::string& GetFileName(const std::size_t& version) const { return versions[version].fileName; }
+	
+	// False if the taxon has no counterpart in the current version (i.e. it was split)
+	bool MapToCurrent(const std::size_t& version, const unsigned int& index, unsigned int& currentIndex) const;
+
+private:
+	static const std::uint32_t noMatch;
+	
+	const std::string userAgent;
+	std::string errorString;
+	
+	struct Version
+	{
+		std::string fileName;
+		std::unique_ptr<TaxonomyOrder> taxonomy;
+		std::vector<std::uint32_t> currentIndices;// Indexed by this version's taxon index; empty for the current version
+	};
+	
+	std::vector<Version> versions;
+	
+	void BuildMappings();
+	static std::uint32_t FindCurrentIndex(const TaxonomyOrder& current, const TaxonomyOrder& previous, const unsigned int& index);
+};
+
+#endif// TAXONOMY_REGISTRY_H_
@@ -0,0 +1,32 @@
+// File:  transferStatistics.h
+// Date:  10/16/2026
+// Auth:  K. Loux
+// Desc:  Byte counts and timing for a single HTTP transfer, so the effect of compression and
+//        connection reuse can be measured.
+
+#ifndef TRANSFER_STATISTICS_H_
+#define TRANSFER_STATISTICS_H_
+
+// Standard C++ headers
+#include <string>
+#include <cstdint>
+
+struct TransferStatistics
+{
+	std::string url;
+	long responseCode = 0;
+	std::string protocol;// e.g. "HTTP/2"
+	std::string contentEncoding;// Empty if the body wasn't compressed
+	bool newConnection = false;// False if the transfer reused (or was multiplexed onto) an existing connection
+
+	std::uint64_t headerBytes = 0;
+	std::uint64_t bodyBytes = 0;// As received, before decoding
+	std::uint64_t decodedBytes = 0;// After decoding
+
+	double nameLookupTime = 0.0;// [sec] Zero for reused connections
+	double connectTime = 0.0;// [sec] Including TLS handshake; zero for reused connections
+	double timeToFirstByte = 0.0;// [sec]
+	double totalTime = 0.0;// [sec]
+};
+
+#endif// TRANSFER_STATISTICS_H_